@@ -16,15 +16,20 @@
 #include <iostream>
 #include <map>
 #include <string>
+#include <vector>
 
 #include "vendor/Date.hpp"
+#include "vendor/PriceIndex.hpp"
 #include "vendor/csv.hpp"
 
 #if HAVE_MY_SQL_LITE
 #include "vendor/Database.hpp"
 #include "vendor/Database_utils.hpp"
+#include "vendor/PriceFeed.hpp"
 #endif
 
+class PriceFeed;
+
 class BitcoinExchange {
  public:
   BitcoinExchange();
@@ -34,9 +39,25 @@ class BitcoinExchange {
   ~BitcoinExchange();
 
   void loadDatabase(const std::string &dbPath);
+  // Maps the shared index of dbPath (vendor/PriceIndex.hpp) when one
+  // matches the file; otherwise loads it and publishes the index
+  void loadCached(const std::string &dbPath);
   void processInputFile(const std::string &inputPath) const;
+  // Prints what processInputFile does, resolving the whole file at once:
+  // the lines are radix-sorted by date and meet the price history in one
+  // merge pass.  sortedOutput prints the results in date order instead,
+  // after every error.
+  void processBatch(const std::string &inputPath,
+                    bool sortedOutput = false) const;
+  void processLine(const std::string &line, std::ostream &out,
+                   std::ostream &err) const;
+  static bool isHeaderLine(const std::string &line);
 
 #if HAVE_MY_SQL_LITE
+  // Answers from feed from now on (vendor/PriceFeed.hpp), which must
+  // outlive this object; lookups must run while the calling thread is
+  // one of its online readers
+  void follow(const PriceFeed &feed);
   // ── MySQLite rich mode ──────────────────────────────────────────────
   // Processes the input file and renders a styled table with results
   void processAndRender(const std::string &inputPath,
@@ -50,14 +71,22 @@ class BitcoinExchange {
 
  private:
   std::map<std::string, double> _priceDb;
+  PriceIndex _index;  // used instead of _priceDb when attached
+  const PriceFeed *_feed;  // used instead of both when set
+
+  size_t _priceCount() const;
+  bool _priceHistory(std::vector<uint32_t> &keys,
+                     std::vector<double> &rates) const;
 
   bool _isValidDate(const std::string &date) const;
-  bool _isValidValue(const std::string &value, double &out) const;
+  bool _isValidValue(const std::string &value, double &out,
+                     std::ostream &err) const;
   double _getExchangeRate(const std::string &date) const;
   static std::string _trim(const std::string &s);
 
 #if HAVE_MY_SQL_LITE
   static RenderConfig _getStyle(const std::string &name);
+  void _fillPriceTable(Database &db) const;
 #endif
 };
 
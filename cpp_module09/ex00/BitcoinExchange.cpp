@@ -12,7 +12,13 @@
 
 #include "BitCoinExchange.hpp"
 
+#include <stdint.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <fstream>
 #include <limits>
 #include <sstream>
@@ -21,17 +27,21 @@
 // Orthodox Canonical Form
 // ============================================================================
 
-BitcoinExchange::BitcoinExchange() {}
+BitcoinExchange::BitcoinExchange() : _feed(NULL) {}
 
-BitcoinExchange::BitcoinExchange(const std::string &dbPath) {
+BitcoinExchange::BitcoinExchange(const std::string &dbPath) : _feed(NULL) {
   loadDatabase(dbPath);
 }
 
 BitcoinExchange::BitcoinExchange(const BitcoinExchange &other)
-    : _priceDb(other._priceDb) {}
+    : _priceDb(other._priceDb), _index(other._index), _feed(other._feed) {}
 
 BitcoinExchange &BitcoinExchange::operator=(const BitcoinExchange &other) {
-  if (this != &other) _priceDb = other._priceDb;
+  if (this != &other) {
+    _priceDb = other._priceDb;
+    _index = other._index;
+    _feed = other._feed;
+  }
   return *this;
 }
 
@@ -42,6 +52,7 @@ BitcoinExchange::~BitcoinExchange() {}
 // ============================================================================
 
 void BitcoinExchange::loadDatabase(const std::string &dbPath) {
+  _index.detach();
   CSV::Parser::Options opts;
   opts.delimiter = ',';
   opts.hasHeader = true;
@@ -49,7 +60,12 @@ void BitcoinExchange::loadDatabase(const std::string &dbPath) {
   opts.skipEmptyLines = true;
 
   CSV::Document doc;
-  if (!doc.load(dbPath, opts))
+#if HAVE_MY_SQL_LITE
+  bool loaded = CsvChunks::load(doc, dbPath, opts);
+#else
+  bool loaded = doc.load(dbPath, opts);
+#endif
+  if (!loaded)
     throw std::runtime_error("Error: could not open database file.");
 
   int dateIdx = doc.getColumnIndex("date");
@@ -66,6 +82,57 @@ void BitcoinExchange::loadDatabase(const std::string &dbPath) {
   }
 }
 
+// The key is taken before parsing: if the CSV changes meanwhile, the index
+// written from the old contents no longer matches and the next run rebuilds.
+void BitcoinExchange::loadCached(const std::string &dbPath) {
+  PriceIndex::Key key;
+  bool keyed = PriceIndex::keyFor(dbPath, key);
+  if (keyed && _index.attach(key)) {
+    _priceDb.clear();
+    return;
+  }
+  loadDatabase(dbPath);
+  if (keyed) PriceIndex::build(key, _priceDb);  // best effort
+}
+
+#if HAVE_MY_SQL_LITE
+void BitcoinExchange::follow(const PriceFeed &feed) {
+  _priceDb.clear();
+  _index.detach();
+  _feed = &feed;
+}
+#endif
+
+size_t BitcoinExchange::_priceCount() const {
+  return _index.attached() ? _index.size() : _priceDb.size();
+}
+
+// The history as sorted YYYYMMDD keys; false when it cannot be (a date in
+// _priceDb that is not YYYY-MM-DD, or a feed)
+bool BitcoinExchange::_priceHistory(std::vector<uint32_t> &keys,
+                                    std::vector<double> &rates) const {
+#if HAVE_MY_SQL_LITE
+  if (_feed) return false;
+#endif
+  keys.reserve(_priceCount());
+  rates.reserve(_priceCount());
+  if (_index.attached()) {
+    for (size_t i = 0; i < _index.size(); ++i) {
+      keys.push_back(_index.key(i));
+      rates.push_back(_index.rate(i));
+    }
+    return true;
+  }
+  for (std::map<std::string, double>::const_iterator it = _priceDb.begin();
+       it != _priceDb.end(); ++it) {
+    uint32_t key;
+    if (!PriceIndex::dateKey(it->first, key)) return false;
+    keys.push_back(key);
+    rates.push_back(it->second);
+  }
+  return true;
+}
+
 // ============================================================================
 // Input file processing
 // ============================================================================
@@ -83,43 +150,354 @@ void BitcoinExchange::processInputFile(const std::string &inputPath) const {
   while (std::getline(file, line)) {
     if (firstLine) {
       firstLine = false;
-      // Skip header line (expected: "date | value")
-      std::string trimmed = _trim(line);
-      if (trimmed.find("date") != std::string::npos &&
-          trimmed.find("value") != std::string::npos)
-        continue;
+      if (isHeaderLine(line)) continue;
     }
 
-    // Parse "date | value"
-    size_t pipePos = line.find('|');
-    if (pipePos == std::string::npos) {
-      std::cerr << "Error: bad input => " << _trim(line) << std::endl;
-      continue;
-    }
+    processLine(line, std::cout, std::cerr);
+  }
+}
 
-    std::string dateStr = _trim(line.substr(0, pipePos));
-    std::string valueStr = _trim(line.substr(pipePos + 1));
+// The "date | value" header an input file may start with
+bool BitcoinExchange::isHeaderLine(const std::string &line) {
+  std::string trimmed = _trim(line);
+  return trimmed.find("date") != std::string::npos &&
+         trimmed.find("value") != std::string::npos;
+}
 
-    // Validate date
-    if (!_isValidDate(dateStr)) {
-      std::cerr << "Error: bad input => " << dateStr << std::endl;
+// One "date | value" line: the result goes to out, a complaint to err
+void BitcoinExchange::processLine(const std::string &line, std::ostream &out,
+                                  std::ostream &err) const {
+  // Parse "date | value"
+  size_t pipePos = line.find('|');
+  if (pipePos == std::string::npos) {
+    err << "Error: bad input => " << _trim(line) << std::endl;
+    return;
+  }
+
+  std::string dateStr = _trim(line.substr(0, pipePos));
+  std::string valueStr = _trim(line.substr(pipePos + 1));
+
+  // Validate date
+  if (!_isValidDate(dateStr)) {
+    err << "Error: bad input => " << dateStr << std::endl;
+    return;
+  }
+
+  // Validate value
+  double value = 0;
+  if (!_isValidValue(valueStr, value, err)) return;
+
+  // Get exchange rate and output
+  double rate = _getExchangeRate(dateStr);
+  if (rate < 0) {
+    err << "Error: date too early for database." << std::endl;
+    return;
+  }
+
+  double result = value * rate;
+  out << dateStr << " => " << valueStr << " = " << result << std::endl;
+}
+
+// ============================================================================
+// Batch processing - radix sort by date, one merge against the history
+// ============================================================================
+
+namespace {
+
+enum BatchStatus { BATCH_OK, BAD_INPUT, NOT_POSITIVE, TOO_LARGE, TOO_EARLY };
+
+struct BatchRecord {
+  uint32_t key;  // YYYYMMDD
+  uint32_t status;
+  double value;
+  double rate;
+  size_t datePos;
+  size_t textPos;  // the value, or what a bad input line complains about
+  size_t textLen;
+};
+
+bool isBlank(char c) {
+  return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// [b, e) without the blanks _trim strips
+void trimRange(const char *&b, const char *&e) {
+  while (b < e && isBlank(*b)) ++b;
+  while (e > b && isBlank(e[-1])) --e;
+}
+
+// YYYYMMDD of a date _isValidDate accepts; false for any other
+bool batchDateKey(const char *p, size_t n, uint32_t &key) {
+  if (n != 10 || p[4] != '-' || p[7] != '-') return false;
+  key = 0;
+  for (size_t i = 0; i < 10; ++i) {
+    if (i == 4 || i == 7) continue;
+    unsigned d = static_cast<unsigned char>(p[i]) - '0';
+    if (d > 9) return false;
+    key = key * 10 + d;
+  }
+  int year = static_cast<int>(key / 10000);
+  int month = static_cast<int>(key / 100 % 100);
+  int day = static_cast<int>(key % 100);
+  return year >= 1 && day >= 1 && day <= Date::daysInMonth(year, month);
+}
+
+// strtod for plain decimals ("12", "0.25", "7."): with at most 15 digits
+// the digits and the power of ten under them are both exact doubles, so
+// one correctly rounded division gives strtod's answer.  Anything else is
+// left to strtod.
+bool fastDecimal(const char *b, const char *e, double &out) {
+  static const double kPow10[16] = {1e0,  1e1,  1e2,  1e3,  1e4,  1e5,
+                                    1e6,  1e7,  1e8,  1e9,  1e10, 1e11,
+                                    1e12, 1e13, 1e14, 1e15};
+  uint64_t mantissa = 0;
+  int digits = 0, decimals = -1;
+  for (const char *p = b; p < e; ++p) {
+    if (*p == '.' && decimals < 0) {
+      decimals = 0;
       continue;
     }
+    unsigned d = static_cast<unsigned char>(*p) - '0';
+    if (d > 9 || ++digits > 15) return false;
+    mantissa = mantissa * 10 + d;
+    if (decimals >= 0) ++decimals;
+  }
+  if (digits == 0) return false;
+  out = static_cast<double>(mantissa) / kPow10[decimals < 0 ? 0 : decimals];
+  return true;
+}
 
-    // Validate value
-    double value = 0;
-    if (!_isValidValue(valueStr, value)) continue;
+// x as ostream prints it (%g: 6 significant digits) for x in [1e-16,
+// 1e22), when x is not too close to a rounding tie to be sure of the
+// digits: scaled to six digits before the point by one exact power of ten
+// (one rounding, error < 1e-9), the fraction must be more than 1e-7 away
+// from .5.  False otherwise, for snprintf to do it.
+bool fastG6(double x, char *buf, int &len) {
+  static const double kPow10[39] = {
+      1e-16, 1e-15, 1e-14, 1e-13, 1e-12, 1e-11, 1e-10, 1e-9, 1e-8, 1e-7,
+      1e-6,  1e-5,  1e-4,  1e-3,  1e-2,  1e-1,  1e0,   1e1,  1e2,  1e3,
+      1e4,   1e5,   1e6,   1e7,   1e8,   1e9,   1e10,  1e11, 1e12, 1e13,
+      1e14,  1e15,  1e16,  1e17,  1e18,  1e19,  1e20,  1e21, 1e22};
+  if (!(x >= 1e-16 && x < 1e22)) return false;
+  // 10^e <= x < 10^(e+1), give or take a rounding
+  int e = static_cast<int>(std::upper_bound(kPow10, kPow10 + 39, x) -
+                           kPow10) - 17;
+  double y = e <= 5 ? x * kPow10[16 + 5 - e] : x / kPow10[16 + e - 5];
+  double whole = std::floor(y);
+  double frac = y - whole;
+  if (whole < 100000 || whole > 999999 || std::fabs(frac - 0.5) < 1e-7)
+    return false;
+  uint32_t d = static_cast<uint32_t>(whole) + (frac > 0.5 ? 1 : 0);
+  if (d > 999999) return false;
+  char digits[6];
+  for (int i = 5; i >= 0; --i, d /= 10)
+    digits[i] = static_cast<char>('0' + d % 10);
+  bool fixed = e >= -4 && e < 6;
+  int point = fixed && e > 0 ? e : 0;  // last digit before the point
+  int last = 5;                        // trailing zeros after it go
+  while (last > point && digits[last] == '0') --last;
+  len = 0;
+  if (fixed && e < 0) {
+    buf[len++] = '0';
+    buf[len++] = '.';
+    for (int i = -1; i > e; --i) buf[len++] = '0';
+    for (int i = 0; i <= last; ++i) buf[len++] = digits[i];
+    return true;
+  }
+  for (int i = 0; i <= point; ++i) buf[len++] = digits[i];
+  if (last > point) {
+    buf[len++] = '.';
+    for (int i = point + 1; i <= last; ++i) buf[len++] = digits[i];
+  }
+  if (!fixed) {
+    int a = e < 0 ? -e : e;
+    buf[len++] = 'e';
+    buf[len++] = e < 0 ? '-' : '+';
+    buf[len++] = static_cast<char>('0' + a / 10);
+    buf[len++] = static_cast<char>('0' + a % 10);
+  }
+  return true;
+}
 
-    // Get exchange rate and output
-    double rate = _getExchangeRate(dateStr);
-    if (rate < 0) {
-      std::cerr << "Error: date too early for database." << std::endl;
-      continue;
+// One input line, as processLine judges it up to the rate lookup
+void parseBatchLine(const char *base, const char *b, const char *e,
+                    BatchRecord &r) {
+  r.status = BAD_INPUT;
+  const char *pipe = static_cast<const char *>(std::memchr(b, '|', e - b));
+  if (!pipe) {
+    trimRange(b, e);
+    r.textPos = b - base;
+    r.textLen = e - b;
+    return;
+  }
+  const char *db = b, *de = pipe;
+  trimRange(db, de);
+  if (!batchDateKey(db, de - db, r.key)) {
+    r.textPos = db - base;
+    r.textLen = de - db;
+    return;
+  }
+  r.datePos = db - base;
+  const char *vb = pipe + 1, *ve = e;
+  trimRange(vb, ve);
+  r.textPos = vb - base;
+  r.textLen = ve - vb;
+  if (vb == ve) return;
+  // the buffer ends in a NUL and a value is followed by a blank, so strtod
+  // stops where it would on the trimmed copy processLine makes
+  if (!fastDecimal(vb, ve, r.value)) {
+    char *end = NULL;
+    r.value = std::strtod(vb, &end);
+    if (end == vb || (end != ve && *end != '\0')) return;
+  }
+  if (r.value < 0)
+    r.status = NOT_POSITIVE;
+  else if (r.value > 1000)
+    r.status = TOO_LARGE;
+  else
+    r.status = BATCH_OK;
+}
+
+// Dense sort key: (year * 16 + month) * 32 + day, 23 bits for year 9999
+uint32_t packedDay(uint32_t key) {
+  return (key / 10000 * 16 + key / 100 % 100) * 32 + key % 100;
+}
+
+// Stable LSD radix sort of (packed day << 32 | record) in two 12-bit passes
+void radixSort(std::vector<uint64_t> &v) {
+  std::vector<uint64_t> tmp(v.size());
+  for (int shift = 32; shift < 56; shift += 12) {
+    std::vector<size_t> count(4097, 0);
+    for (size_t i = 0; i < v.size(); ++i)
+      ++count[((v[i] >> shift) & 4095) + 1];
+    if (count[((v[0] >> shift) & 4095) + 1] == v.size()) continue;
+    for (size_t b = 1; b < count.size(); ++b) count[b] += count[b - 1];
+    for (size_t i = 0; i < v.size(); ++i)
+      tmp[count[(v[i] >> shift) & 4095]++] = v[i];
+    v.swap(tmp);
+  }
+}
+
+void writeBatchLine(const std::string &text, const BatchRecord &r,
+                    std::string &out) {
+  char num[32];
+  int n;
+  if (!fastG6(r.value * r.rate, num, n))
+    n = std::snprintf(num, sizeof(num), "%g", r.value * r.rate);
+  out.append(text, r.datePos, 10);
+  out += " => ";
+  out.append(text, r.textPos, r.textLen);
+  out += " = ";
+  out.append(num, static_cast<size_t>(n));
+  out += '\n';
+}
+
+void flushBatch(std::string &out) {
+  std::cout.write(out.data(), static_cast<std::streamsize>(out.size()));
+  out.clear();
+}
+
+void reportBatch(const std::string &text, const BatchRecord &r,
+                 std::string &out) {
+  if (r.status == BATCH_OK) {
+    writeBatchLine(text, r, out);
+    if (out.size() >= 1 << 16) flushBatch(out);
+    return;
+  }
+  flushBatch(out);  // keep stdout and stderr in line order
+  std::cout.flush();
+  if (r.status == BAD_INPUT)
+    std::cerr << "Error: bad input => " << text.substr(r.textPos, r.textLen)
+              << std::endl;
+  else if (r.status == NOT_POSITIVE)
+    std::cerr << "Error: not a positive number." << std::endl;
+  else if (r.status == TOO_LARGE)
+    std::cerr << "Error: too large a number." << std::endl;
+  else
+    std::cerr << "Error: date too early for database." << std::endl;
+}
+
+}  // namespace
+
+void BitcoinExchange::processBatch(const std::string &inputPath,
+                                   bool sortedOutput) const {
+  std::ifstream file(inputPath.c_str(), std::ios::binary);
+  if (!file.is_open()) {
+    std::cerr << "Error: could not open file." << std::endl;
+    return;
+  }
+  std::string text;
+  {
+    std::ostringstream all;
+    all << file.rdbuf();
+    text = all.str();
+  }
+
+  // Records for every line, in input order
+  std::vector<BatchRecord> records;
+  const char *base = text.c_str();
+  const char *end = base + text.size();
+  records.reserve(
+      static_cast<size_t>(std::count(text.begin(), text.end(), '\n')) + 1);
+  bool firstLine = true;
+  for (const char *b = base; b < end;) {
+    const char *e =
+        static_cast<const char *>(std::memchr(b, '\n', end - b));
+    if (!e) e = end;
+    if (firstLine) {
+      firstLine = false;
+      if (isHeaderLine(std::string(b, e))) {
+        b = e + 1;
+        continue;
+      }
     }
+    BatchRecord r;
+    parseBatchLine(base, b, e, r);
+    records.push_back(r);
+    b = e + 1;
+  }
 
-    double result = value * rate;
-    std::cout << dateStr << " => " << valueStr << " = " << result << std::endl;
+  // Valid lines by date, then one pass over the history
+  std::vector<uint64_t> order;
+  order.reserve(records.size());
+  for (size_t i = 0; i < records.size(); ++i)
+    if (records[i].status == BATCH_OK)
+      order.push_back(static_cast<uint64_t>(packedDay(records[i].key)) << 32 |
+                      i);
+  if (!order.empty()) radixSort(order);
+  std::vector<uint32_t> keys;
+  std::vector<double> rates;
+  bool merged = _priceHistory(keys, rates);
+  std::string sorted;  // the results in date order, for sortedOutput
+  size_t h = 0;
+  for (size_t i = 0; i < order.size(); ++i) {
+    BatchRecord &r = records[order[i] & 0xFFFFFFFFu];
+    if (sortedOutput && i + 32 < order.size()) {
+      // records come in date order from all over the file: fetch ahead
+      const BatchRecord &next = records[order[i + 16] & 0xFFFFFFFFu];
+      __builtin_prefetch(&records[order[i + 32] & 0xFFFFFFFFu]);
+      __builtin_prefetch(base + next.datePos);
+      __builtin_prefetch(base + next.textPos);
+    }
+    if (merged) {
+      while (h < keys.size() && keys[h] <= r.key) ++h;
+      r.rate = h ? rates[h - 1] : -1;
+    } else {
+      r.rate = _getExchangeRate(text.substr(r.datePos, 10));
+    }
+    if (r.rate < 0)
+      r.status = TOO_EARLY;
+    else if (sortedOutput)
+      writeBatchLine(text, r, sorted);  // while the record is in cache
   }
+
+  std::string out;
+  for (size_t i = 0; i < records.size(); ++i)
+    if (!sortedOutput || records[i].status != BATCH_OK)
+      reportBatch(text, records[i], out);
+  flushBatch(out);
+  flushBatch(sorted);
+  std::cout.flush();
 }
 
 // ============================================================================
@@ -148,10 +526,10 @@ bool BitcoinExchange::_isValidDate(const std::string &date) const {
 // Value validation
 // ============================================================================
 
-bool BitcoinExchange::_isValidValue(const std::string &value,
-                                    double &out) const {
+bool BitcoinExchange::_isValidValue(const std::string &value, double &out,
+                                    std::ostream &err) const {
   if (value.empty()) {
-    std::cerr << "Error: bad input => " << value << std::endl;
+    err << "Error: bad input => " << value << std::endl;
     return false;
   }
 
@@ -159,16 +537,16 @@ bool BitcoinExchange::_isValidValue(const std::string &value,
   out = std::strtod(value.c_str(), &endptr);
 
   if (endptr == value.c_str() || (endptr != NULL && *endptr != '\0')) {
-    std::cerr << "Error: bad input => " << value << std::endl;
+    err << "Error: bad input => " << value << std::endl;
     return false;
   }
 
   if (out < 0) {
-    std::cerr << "Error: not a positive number." << std::endl;
+    err << "Error: not a positive number." << std::endl;
     return false;
   }
   if (out > 1000) {
-    std::cerr << "Error: too large a number." << std::endl;
+    err << "Error: too large a number." << std::endl;
     return false;
   }
   return true;
@@ -179,6 +557,16 @@ bool BitcoinExchange::_isValidValue(const std::string &value,
 // ============================================================================
 
 double BitcoinExchange::_getExchangeRate(const std::string &date) const {
+#if HAVE_MY_SQL_LITE
+  if (_feed) {
+    double rate;
+    return _feed->lookup(date, rate) ? rate : -1;
+  }
+#endif
+  if (_index.attached()) {
+    double rate;
+    return _index.lookup(date, rate) ? rate : -1;
+  }
   if (_priceDb.empty()) return -1;
 
   // Try exact match first
@@ -220,6 +608,34 @@ RenderConfig BitcoinExchange::_getStyle(const std::string &name) {
   return StylePresets::ocean();
 }
 
+// Date | Exchange Rate rows from whichever store holds the prices
+void BitcoinExchange::_fillPriceTable(Database &db) const {
+  db.addColumn("Date", ColumnType::DATE, Alignment::LEFT);
+  db.addColumn("Exchange Rate", ColumnType::DOUBLE, Alignment::RIGHT);
+
+  std::map<std::string, double>::const_iterator it = _priceDb.begin();
+  for (size_t i = 0; i < _priceCount(); ++i) {
+    std::string date;
+    double rate;
+    if (_index.attached()) {
+      date = _index.date(i);
+      rate = _index.rate(i);
+    } else {
+      date = it->first;
+      rate = it->second;
+      ++it;
+    }
+    std::map<std::string, std::string> row;
+    row["Date"] = date;
+    {
+      std::ostringstream oss;
+      oss << rate;
+      row["Exchange Rate"] = oss.str();
+    }
+    db.addRow(row);
+  }
+}
+
 // ──────────────────────────────────────────────────────────────────────
 // processAndRender: parse input, evaluate, build a Table, render it
 // ──────────────────────────────────────────────────────────────────────
@@ -390,20 +806,7 @@ void BitcoinExchange::processAndRender(const std::string &inputPath,
 void BitcoinExchange::showDatabase(const std::string &styleName,
                                    size_t maxRows) const {
   Database db;
-  db.addColumn("Date", ColumnType::DATE, Alignment::LEFT);
-  db.addColumn("Exchange Rate", ColumnType::DOUBLE, Alignment::RIGHT);
-
-  for (std::map<std::string, double>::const_iterator it = _priceDb.begin();
-       it != _priceDb.end(); ++it) {
-    std::map<std::string, std::string> row;
-    row["Date"] = it->first;
-    {
-      std::ostringstream oss;
-      oss << it->second;
-      row["Exchange Rate"] = oss.str();
-    }
-    db.addRow(row);
-  }
+  _fillPriceTable(db);
 
   Table tbl = db.table();
   if (maxRows > 0) tbl = Transform::limit(tbl, maxRows);
@@ -413,7 +816,7 @@ void BitcoinExchange::showDatabase(const std::string &styleName,
   cfg.showFooter = true;
   {
     std::ostringstream footer;
-    footer << "Bitcoin Price Database — " << _priceDb.size() << " entries";
+    footer << "Bitcoin Price Database — " << _priceCount() << " entries";
     cfg.footerText = footer.str();
   }
   cfg.footerStyle.foreground = Style::Color::BrightCyan();
@@ -432,20 +835,7 @@ void BitcoinExchange::showDatabase(const std::string &styleName,
 
 void BitcoinExchange::showStats() const {
   Database db;
-  db.addColumn("Date", ColumnType::DATE, Alignment::LEFT);
-  db.addColumn("Exchange Rate", ColumnType::DOUBLE, Alignment::RIGHT);
-
-  for (std::map<std::string, double>::const_iterator it = _priceDb.begin();
-       it != _priceDb.end(); ++it) {
-    std::map<std::string, std::string> row;
-    row["Date"] = it->first;
-    {
-      std::ostringstream oss;
-      oss << it->second;
-      row["Exchange Rate"] = oss.str();
-    }
-    db.addRow(row);
-  }
+  _fillPriceTable(db);
 
   Statistics::ColumnStats stats =
       Statistics::analyze(db.table(), "Exchange Rate");
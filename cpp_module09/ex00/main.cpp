@@ -10,6 +10,11 @@
 /*                                                                            */
 /* ************************************************************************** */
 
+#if HAVE_MY_SQL_LITE
+// EXPLAIN ANALYZE reports bytes allocated (see vendor/Profiler.hpp)
+#define MYSQLITE_COUNT_ALLOCATIONS 1
+#endif
+
 #include <cstring>
 #include <fstream>
 #include <iostream>
@@ -18,6 +23,93 @@
 
 #if HAVE_MY_SQL_LITE
 #include "vendor/MySQLiteRepl.hpp"
+#include "vendor/QueryServer.hpp"
+
+// `date | value` requests of --serve, answered as the classic mode prints
+class PriceLookup : public QueryServer::Lookup {
+ public:
+  explicit PriceLookup(const BitcoinExchange &btc) : _btc(btc) {}
+
+  void lookup(const std::string &line, bool first, std::ostream &out) {
+    if (first && BitcoinExchange::isHeaderLine(line)) return;
+    _btc.processLine(line, out, out);
+  }
+
+ private:
+  const BitcoinExchange &_btc;
+};
+
+// Keeps the catalog table name in step with feed: each statement (or
+// server round) first adds the lines appended to data.csv since the last
+class FollowedTable : public StatementHook {
+ public:
+  FollowedTable(PriceFeed &feed, const std::string &name)
+      : _feed(feed), _name(name), _reader(feed.addReader()) {}
+
+  void begin(Executor &executor) {
+    _feed.online(_reader);
+    Database *db = executor.findTable(_name);
+    if (db)
+      _feed.apply(*db, _cursor);
+    else
+      _cursor = PriceFeed::Cursor();  // dropped: rebuilt if it comes back
+  }
+
+  void end() { _feed.offline(_reader); }
+
+ private:
+  PriceFeed &_feed;
+  std::string _name;
+  size_t _reader;
+  PriceFeed::Cursor _cursor;
+};
+
+static QueryServer *g_server = NULL;
+
+static void stopServer(int) {
+  if (g_server) g_server->stop();
+}
+
+// Keeps the price index and the MySQLite catalog (btc) resident and
+// answers clients on socketPath until SIGINT / SIGTERM.  With feed, both
+// follow data.csv as it grows instead.
+static int serve(const std::string &socketPath, bool cached,
+                 PriceFeed *feed) {
+  BitcoinExchange btc;
+  Executor executor;
+  if (feed) {
+    btc.follow(*feed);
+    executor.addTable("btc", Database());  // filled by the first round
+  } else {
+    if (cached)
+      btc.loadCached("data.csv");
+    else
+      btc.loadDatabase("data.csv");
+    Database priceDb;
+    priceDb.loadFromCsv("data.csv");
+    priceDb.table().compress();
+    executor.addTable("btc", priceDb);
+  }
+  PriceLookup lookup(btc);
+  QueryServer server(executor, lookup);
+  server.listen(socketPath);
+  FollowedTable *followed = feed ? new FollowedTable(*feed, "btc") : NULL;
+  server.setHook(followed);
+
+  struct sigaction sa;
+  std::memset(&sa, 0, sizeof(sa));
+  sa.sa_handler = stopServer;
+  sigemptyset(&sa.sa_mask);
+  g_server = &server;
+  sigaction(SIGINT, &sa, NULL);
+  sigaction(SIGTERM, &sa, NULL);
+  std::cerr << "Serving on " << socketPath << " (Ctrl-C to stop)" << std::endl;
+  server.run();
+  g_server = NULL;
+  delete followed;
+  std::cerr << "Served " << server.requests() << " requests." << std::endl;
+  return 0;
+}
 
 static void printHelp(void) {
   std::cout
@@ -30,7 +122,18 @@ static void printHelp(void) {
       << "  --db-limit <n>   Limit DB rows shown (default: all)\n"
       << "  --stats          Show statistics on exchange rates\n"
       << "  --classic        Run classic 42 output (no table rendering)\n"
+      << "  --batch          Classic output, resolving the whole input file\n"
+      << "                   in one sorted pass (for very large inputs)\n"
+      << "  --sorted-output  With --batch: results in date order, after\n"
+      << "                   every error\n"
+      << "  --cache          Map data.csv's shared price index, building it\n"
+      << "                   on first use or when data.csv changes\n"
       << "  -i, --interactive  Launch MySQLite interactive REPL shell\n"
+      << "  --serve <sock>   Answer `date | value` lines and SQL statements\n"
+      << "                   from clients on a Unix socket\n"
+      << "  --client <sock>  Send stdin to a --serve daemon, print replies\n"
+      << "  --follow         With -i or --serve: pick up rows appended to\n"
+      << "                   data.csv while running\n"
       << "  --help           Show this message\n";
 }
 
@@ -40,7 +143,13 @@ int main(int argc, char **argv) {
   bool showDb = false;
   bool showStats = false;
   bool classicMode = false;
+  bool batch = false;
+  bool sortedOutput = false;
   bool interactive = false;
+  bool cached = false;
+  bool follow = false;
+  std::string servePath;
+  std::string clientPath;
   size_t dbLimit = 0;
 
   for (int i = 1; i < argc; ++i) {
@@ -58,8 +167,20 @@ int main(int argc, char **argv) {
       showStats = true;
     else if (arg == "--classic")
       classicMode = true;
+    else if (arg == "--batch")
+      batch = true;
+    else if (arg == "--sorted-output")
+      sortedOutput = true;
     else if (arg == "--interactive" || arg == "-i")
       interactive = true;
+    else if (arg == "--cache")
+      cached = true;
+    else if (arg == "--follow")
+      follow = true;
+    else if (arg == "--serve" && i + 1 < argc)
+      servePath = argv[++i];
+    else if (arg == "--client" && i + 1 < argc)
+      clientPath = argv[++i];
     else if (arg[0] != '-')
       inputFile = arg;
     else {
@@ -69,33 +190,62 @@ int main(int argc, char **argv) {
     }
   }
 
-  if (inputFile.empty() && !showDb && !showStats && !interactive) {
+  if (!clientPath.empty()) {
+    if (QueryServer::client(clientPath, STDIN_FILENO, STDOUT_FILENO) == 0)
+      return 0;
+    std::cerr << "Error: lost the server at " << clientPath << "."
+              << std::endl;
+    return 1;
+  }
+
+  if (inputFile.empty() && !showDb && !showStats && !interactive &&
+      servePath.empty()) {
     std::cerr << "Error: could not open file." << std::endl;
     return 1;
   }
 
   try {
+    PriceFeed feed("data.csv");
+    if (follow) feed.start();
+    if (!servePath.empty())
+      return serve(servePath, cached, follow ? &feed : NULL);
+
     if (interactive) {
       // Interactive REPL — data.csv is optional, not required
       Repl repl;
+      if (follow) {
+        // appends would decode a compressed table: keep it plain
+        FollowedTable followed(feed, "btc");
+        repl.preload("btc", Database());
+        repl.setHook(&followed);
+        repl.run();
+        return 0;
+      }
       // Try to pre-load the bitcoin price DB if available
       std::ifstream testFile("data.csv");
       if (testFile.is_open()) {
         testFile.close();
         Database priceDb;
         priceDb.loadFromCsv("data.csv");
+        priceDb.table().compress();  // read-only: keep it encoded
         repl.preload("btc", priceDb);
       }
       repl.run();
       return 0;
     }
 
-    BitcoinExchange btc("data.csv");
+    BitcoinExchange btc;
+    if (cached)
+      btc.loadCached("data.csv");
+    else
+      btc.loadDatabase("data.csv");
 
     if (showDb) btc.showDatabase(style, dbLimit);
     if (showStats) btc.showStats();
     if (!inputFile.empty()) {
-      if (classicMode)
+      if (batch)
+        btc.processBatch(inputFile, sortedOutput);
+      else if (classicMode)
         btc.processInputFile(inputFile);
       else
         btc.processAndRender(inputFile, style);
@@ -120,17 +270,36 @@ static void printUsage(void) {
       << "  MySQLite REPL, styled table rendering, and more options.\n"
       << "\n"
       << "OPTIONS (classic build):\n"
+      << "  --cache      Map data.csv's shared price index, building it on\n"
+      << "               first use or when data.csv changes\n"
+      << "  --batch      Resolve the whole input file in one sorted pass\n"
+      << "               (same output, for very large inputs)\n"
+      << "  --sorted-output  With --batch: results in date order, after\n"
+      << "               every error\n"
       << "  -h, --help   Show this message\n";
 }
 
 int main(int argc, char **argv) {
   std::string inputFile;
+  bool cached = false;
+  bool batch = false;
+  bool sortedOutput = false;
 
   for (int i = 1; i < argc; ++i) {
     std::string arg = argv[i];
     if (arg == "--help" || arg == "-h") {
       printUsage();
       return 0;
+    } else if (arg == "--cache") {
+      cached = true;
+    } else if (arg == "--batch") {
+      batch = true;
+    } else if (arg == "--sorted-output") {
+      sortedOutput = true;
+    } else if (arg == "--serve" || arg == "--client" || arg == "--follow") {
+      std::cerr << "Serving requires the MySQLite build.\n"
+                << "Rebuild with:  make sqlite\n";
+      return 1;
     } else if (arg == "--interactive" || arg == "-i") {
       std::cerr << "Interactive mode requires the MySQLite build.\n"
                 << "Rebuild with:  make sqlite\n";
@@ -150,8 +319,15 @@ int main(int argc, char **argv) {
   }
 
   try {
-    BitcoinExchange btc("data.csv");
-    btc.processInputFile(inputFile);
+    BitcoinExchange btc;
+    if (cached)
+      btc.loadCached("data.csv");
+    else
+      btc.loadDatabase("data.csv");
+    if (batch)
+      btc.processBatch(inputFile, sortedOutput);
+    else
+      btc.processInputFile(inputFile);
   } catch (const std::exception &e) {
     std::cerr << e.what() << std::endl;
     return 1;
@@ -0,0 +1,102 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_alter.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/02 10:14:37 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/02 10:15:02 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Cost of ALTER TABLE statements against table size.  With cells addressed
+// by column id, RENAME / MODIFY / ADD ... DEFAULT should not grow with the
+// row count, and DROP only defers work to the per-statement compaction.
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+struct Notes {
+  void columns(Database& db) const {
+    db.addColumn("date");
+    db.addColumn("price", ColumnType::DOUBLE);
+    db.addColumn("note");
+  }
+  void cells(size_t i, std::vector<std::string>& c) const {
+    std::ostringstream d, p;
+    d << "2020-01-" << (i % 28 + 1);
+    p << (i % 1000) * 1.5;
+    c[0] = d.str();
+    c[1] = p.str();
+    c[2] = "some payload that is not tiny";
+  }
+};
+
+static double timeStmt(Executor& ex, const std::string& sql) {
+  double secs;
+  run(ex, sql, secs);
+  return secs;
+}
+
+// Values must survive rename, read the default, and be freed after drop
+static bool check() {
+  Database db = makeTable(10, Notes());
+  Table& tbl = db.table();
+  Table snapshot = tbl;  // shares the schema until tbl changes it
+  tbl.renameColumn("price", "rate");
+  tbl.addColumn(Column("flag"), "yes");
+  tbl.dropColumn("note");
+  while (tbl.compacting()) tbl.compact(3);
+  const Row& r = tbl.rows()[3];
+  if (r.getValue("rate") != "4.5" || r.getValue("flag") != "yes" ||
+      !r.getValue("note").empty() || !r.getValue("price").empty()) {
+    std::cout << "[FAIL] values after ALTER\n";
+    return false;
+  }
+  if (snapshot.rows()[3].getValue("price") != "4.5" ||
+      snapshot.rows()[3].getValue("note").empty() ||
+      snapshot.columns().size() != 3) {
+    std::cout << "[FAIL] copy of the table saw the ALTER\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t big = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 200000;
+  size_t sizes[] = {big / 100, big / 10, big};
+  if (!check()) return 1;
+
+  for (size_t s = 0; s < 3; ++s) {
+    Executor ex;
+    ex.addTable("t", makeTable(sizes[s], Notes()));
+    double rename = timeStmt(ex, "ALTER t RENAME COLUMN price TO rate");
+    double modify = timeStmt(ex, "ALTER t MODIFY COLUMN rate INTEGER");
+    double add = timeStmt(ex, "ALTER t ADD COLUMN flag DEFAULT yes");
+    double drop = timeStmt(ex, "ALTER t DROP COLUMN note");
+    std::cout << "[Result] " << sizes[s] << " rows -> rename "
+              << rename * 1e6 << " us | modify " << modify * 1e6
+              << " us | add default " << add * 1e6 << " us | drop "
+              << drop * 1e6 << " us\n";
+  }
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_alter: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,165 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_asof.cpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/02 15:41:08 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/02 15:43:51 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// ASOF JOIN: cross-check against the classic `btc` output, then time the
+// merge kernel at N x N keys against one binary search per left row.
+//   bench_asof [N=10000000] [prices=samples/data.csv]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <ctime>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "BitCoinExchange.hpp"
+#include "vendor/MySQLiteRepl.hpp"
+
+// Deterministic LCG so runs are comparable
+static unsigned long g_seed = 42;
+static unsigned long nextRand() {
+  g_seed = g_seed * 6364136223846793005UL + 1442695040888963407UL;
+  return g_seed >> 33;
+}
+
+static std::string randomDate() {
+  char buf[16];
+  std::sprintf(buf, "%04lu-%02lu-%02lu", 2008 + nextRand() % 16,
+               1 + nextRand() % 12, 1 + nextRand() % 28);
+  return buf;
+}
+
+// Same lines processInputFile prints for the rows that have a rate
+static bool crossCheck(const std::string& pricesPath, size_t trades) {
+  std::string inputPath = "/tmp/bench_asof_input.txt";
+  std::ofstream in(inputPath.c_str());
+  Database tradeDb;
+  tradeDb.addColumn("date");
+  tradeDb.addColumn("value");
+  in << "date | value\n";
+  for (size_t i = 0; i < trades; ++i) {
+    std::string d = randomDate();
+    std::ostringstream v;
+    v << (nextRand() % 1000);
+    in << d << " | " << v.str() << "\n";
+    std::map<std::string, std::string> row;
+    row["date"] = d;
+    row["value"] = v.str();
+    tradeDb.addRow(row);
+  }
+  in.close();
+
+  // Classic: stdout captured, stderr (too-early dates) discarded
+  std::ostringstream classic;
+  std::streambuf* out = std::cout.rdbuf(classic.rdbuf());
+  std::streambuf* err = std::cerr.rdbuf(NULL);
+  BitcoinExchange btc(pricesPath);
+  btc.processInputFile(inputPath);
+  std::cout.rdbuf(out);
+  std::cerr.rdbuf(err);
+
+  Database prices;
+  prices.loadFromCsv(pricesPath);
+  std::vector<size_t> order, match;
+  std::clock_t start = std::clock();
+  Join::asof(tradeDb.table(), "date", prices.table(), "date", false, order,
+             match);
+  double secs = secondsSince(start);
+
+  std::ostringstream joined;
+  const std::vector<Row>& rows = tradeDb.table().rows();
+  const std::vector<Row>& prows = prices.table().rows();
+  for (size_t i = 0; i < rows.size(); ++i) {
+    if (match[i] == Join::npos) continue;
+    double rate = std::atof(prows[match[i]].getValue("exchange_rate").c_str());
+    double value = std::atof(rows[i].getValue("value").c_str());
+    joined << rows[i].getValue("date") << " => " << rows[i].getValue("value")
+           << " = " << value * rate << "\n";
+  }
+  std::remove(inputPath.c_str());
+
+  if (joined.str() != classic.str()) {
+    std::cout << "[FAIL] ASOF JOIN differs from classic btc output\n";
+    return false;
+  }
+  std::cout << "[OK] " << trades << " trades x " << prows.size()
+            << " prices match classic output (join " << secs * 1e3
+            << " ms)\n";
+  return true;
+}
+
+static void kernel(size_t n) {
+  std::vector<double> right(n), left(n);
+  for (size_t i = 0; i < n; ++i) right[i] = static_cast<double>(i) * 4;
+  for (size_t i = 0; i < n; ++i)
+    left[i] = static_cast<double>(nextRand() % (4 * n + 8));
+  std::vector<char> all;
+  std::vector<size_t> order, match;
+
+  std::clock_t start = std::clock();
+  Join::merge(left, all, right, all, false, order, match);
+  double unsortedSecs = secondsSince(start);
+
+  // Reference: one O(log n) search per left row
+  start = std::clock();
+  size_t mismatches = 0;
+  for (size_t i = 0; i < n; ++i) {
+    std::vector<double>::const_iterator it =
+        std::upper_bound(right.begin(), right.end(), left[i]);
+    size_t ref = it == right.begin()
+                     ? Join::npos
+                     : static_cast<size_t>(it - right.begin()) - 1;
+    mismatches += ref != match[i];
+  }
+  double searchSecs = secondsSince(start);
+
+  std::sort(left.begin(), left.end());
+  start = std::clock();
+  Join::merge(left, all, right, all, false, order, match);
+  double sortedSecs = secondsSince(start);
+
+  std::cout << "[Result] " << n << " x " << n << " -> merge (sorts left) "
+            << unsortedSecs << " s | merge (both ordered) " << sortedSecs
+            << " s | per-row binary search " << searchSecs << " s"
+            << (mismatches ? " | MISMATCH" : "") << "\n";
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000000;
+  std::string prices = argc > 2 ? argv[2] : "samples/data.csv";
+
+  std::ifstream probe(prices.c_str());
+  if (probe.is_open()) {
+    probe.close();
+    if (!crossCheck(prices, 100000)) return 1;
+  } else {
+    std::cout << "[Skip] cross-check: " << prices << " not found\n";
+  }
+  kernel(n);
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_asof: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
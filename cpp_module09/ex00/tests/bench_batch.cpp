@@ -0,0 +1,171 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_batch.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/12 10:21:36 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/12 11:08:14 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// processInputFile against processBatch on a large input file in random
+// date order, salted with every kind of bad line, answered from the map
+// and from the shared index.  Both must print the same bytes in the same
+// stdout / stderr interleaving; --sorted-output must print the same errors
+// and then the same results, stably sorted by date.
+//   bench_batch [input lines=2000000] [price rows=5000]
+// Build with `make bench`.
+
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitCoinExchange.hpp"
+#include "tests/bench_util.hpp"
+
+// What a run prints: both streams together, and each on its own
+struct Output {
+  std::string all;
+  std::string out;
+  std::string err;
+};
+
+static Output run(const BitcoinExchange& btc, const std::string& input,
+                  bool batch, bool sorted, double& secs) {
+  Output o;
+  std::ostringstream all, out, err;
+  std::streambuf* savedOut = std::cout.rdbuf(all.rdbuf());
+  std::streambuf* savedErr = std::cerr.rdbuf(all.rdbuf());
+  double start = now();
+  if (batch)
+    btc.processBatch(input, sorted);
+  else
+    btc.processInputFile(input);
+  secs = now() - start;
+  std::cout.rdbuf(out.rdbuf());
+  std::cerr.rdbuf(err.rdbuf());
+  if (batch)
+    btc.processBatch(input, sorted);
+  else
+    btc.processInputFile(input);
+  std::cout.rdbuf(savedOut);
+  std::cerr.rdbuf(savedErr);
+  o.all = all.str();
+  o.out = out.str();
+  o.err = err.str();
+  return o;
+}
+
+static bool byDate(const std::string& a, const std::string& b) {
+  return a.compare(0, 10, b, 0, 10) < 0;
+}
+
+// expected's errors, then its results stably sorted by date
+static std::string sortedExpected(const Output& expected) {
+  std::vector<std::string> lines;
+  std::istringstream in(expected.out);
+  std::string line;
+  while (std::getline(in, line)) lines.push_back(line + "\n");
+  std::stable_sort(lines.begin(), lines.end(), byDate);
+  std::string s = expected.err;
+  for (size_t i = 0; i < lines.size(); ++i) s += lines[i];
+  return s;
+}
+
+static bool check(const char* what, const BitcoinExchange& btc,
+                  const std::string& input, size_t lines, size_t bytes) {
+  double lineSecs, batchSecs, sortedSecs;
+  Output expected = run(btc, input, false, false, lineSecs);
+  Output batch = run(btc, input, true, false, batchSecs);
+  Output sorted = run(btc, input, true, true, sortedSecs);
+  std::cout << "[Result] " << what << " | " << lines << " lines | per line "
+            << lineSecs * 1e3 << " ms | batch " << batchSecs * 1e3
+            << " ms (" << static_cast<double>(bytes) / batchSecs / 1e6
+            << " MB/s, x" << lineSecs / batchSecs << ") | sorted "
+            << sortedSecs * 1e3 << " ms\n";
+  if (batch.all != expected.all || batch.out != expected.out ||
+      batch.err != expected.err) {
+    std::cout << "[FAIL] " << what << ": batch output differs\n";
+    return false;
+  }
+  if (sorted.all != sortedExpected(expected) || sorted.err != expected.err) {
+    std::cout << "[FAIL] " << what << ": sorted output differs\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t lines = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+  size_t rows = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 5000;
+
+  char dir[] = "/tmp/bench_batch.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  setenv("BTC_INDEX_DIR", dir, 1);
+  std::string base(dir);
+  std::string csv = base + "/data.csv", input = base + "/input.txt";
+  {
+    std::ofstream out(csv.c_str());
+    out << "date,exchange_rate\n";
+    for (size_t i = 100; i < rows; ++i)
+      out << day(i) << "," << static_cast<double>(i * 37 % 99991) / 10
+          << "\n";
+  }
+  static const char* const kBad[] = {
+      "",
+      "no pipe here",
+      "2012-02-30 | 1",
+      "2011-13-01 | 1",
+      "0000-01-01 | 1",
+      "2012-1-01 | 1",
+      " 2012-01-01 |",
+      "2012-01-01 | abc",
+      "2012-01-01 | 1.5x",
+      "2012-01-01 | -3",
+      "2012-01-01 | 1001",
+      "2012-01-01 | nan",
+      "2012-01-01 | 1e2",
+      "\t2012-02-29 |  7 \r",
+      "2009-01-01 | 1",  // before the history
+      "2012-01-01 | 2 | 3",
+  };
+  size_t bytes = 0;
+  {
+    std::ofstream in(input.c_str());
+    in << "date | value\n";
+    srand(42);
+    for (size_t i = 0; i < lines; ++i) {
+      std::ostringstream line;
+      if (i % 97 == 0)
+        line << kBad[i / 97 % (sizeof(kBad) / sizeof(kBad[0]))];
+      else
+        line << day(static_cast<size_t>(rand()) % (rows + 200)) << " | "
+             << rand() % 100001 / 100.0;
+      line << "\n";
+      in << line.str();
+      bytes += line.str().size();
+    }
+    in << "2013-05-05 | 3";  // no final newline
+  }
+
+  BitcoinExchange parsed(csv);
+  BitcoinExchange cached;
+  cached.loadCached(csv);
+  BitcoinExchange mapped;
+  mapped.loadCached(csv);
+  if (!check("map", parsed, input, lines, bytes) ||
+      !check("index", mapped, input, lines, bytes))
+    return 1;
+
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
@@ -0,0 +1,245 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_cache.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/15 15:34:50 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/15 16:48:12 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// A dashboard's statements repeated against an unchanged trades table,
+// through an Executor with the result cache and one with SET CACHE 0:
+// the first round misses, the later ones hit, and every answer must be
+// the uncached one.  Then each kind of write (INSERT, UPDATE, DELETE,
+// ALTER, LOAD) lands between two rounds, and the round after it must see
+// it.  A miss is timed against the cache off on the same table.  A small
+// cache must stay under its limit by evicting.  SHOW CACHE reports the
+// counters at the end.
+//   bench_cache [rows=1000000] [rounds=20]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+static const char* kDashboard[] = {
+    "AVG price FROM t WHERE symbol = 'BTC'",
+    "SUM quantity FROM t WHERE side = 'BUY' AND price > 50000",
+    "COUNT t WHERE quantity > 990",
+    "MAX price FROM t WHERE symbol = 'ETH'",
+    "STATS price FROM t",
+    "SELECT id, symbol, price FROM t WHERE symbol = 'SOL' ORDER BY price "
+    "DESC LIMIT 20",
+    "COUNT(DISTINCT time) FROM t WHERE side = 'SELL'",
+};
+static const size_t kStatements = sizeof(kDashboard) / sizeof(kDashboard[0]);
+
+// Every dashboard statement on both executors; secs get each side's time
+static bool round(Executor& cached, Executor& plain, const std::string& when,
+                  double& cachedSecs, double& plainSecs) {
+  cachedSecs = plainSecs = 0;
+  for (size_t i = 0; i < kStatements; ++i) {
+    double a, b;
+    std::string hit = run(cached, kDashboard[i], a);
+    std::string fresh = run(plain, kDashboard[i], b);
+    cachedSecs += a;
+    plainSecs += b;
+    if (hit != fresh) {
+      std::cout << "[FAIL] " << when << ": '" << kDashboard[i]
+                << "' differs from the uncached answer\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+// A write on both executors, then a round that must see it.  Each
+// executor scans its own copy of the table, and the copies differ by
+// several percent after a write either way; missCost() compares like
+// with like.
+static bool afterWrite(Executor& cached, Executor& plain,
+                       const std::string& sql) {
+  double secs, c, p;
+  run(cached, sql, secs);
+  run(plain, sql, secs);
+  if (!round(cached, plain, "after " + sql, c, p)) return false;
+  std::cout << "[Result] after " << sql.substr(0, sql.find(' ')) << " | "
+            << c * 1e3 << " ms (uncached " << p * 1e3 << " ms)\n";
+  return true;
+}
+
+// The dashboard on one executor and table, as misses that fill the cache
+// and with the cache off, best of three: what a miss costs on top
+static void missCost(Executor& ex) {
+  double miss = 0, off = 0, secs;
+  for (size_t i = 0; i < kStatements; ++i) {
+    double bestMiss = 0, bestOff = 0;
+    for (size_t r = 0; r < 3; ++r) {
+      run(ex, "SET CACHE 0", secs);  // empties it
+      run(ex, kDashboard[i], secs);
+      if (r == 0 || secs < bestOff) bestOff = secs;
+      run(ex, "SET CACHE 64", secs);
+      run(ex, kDashboard[i], secs);
+      if (r == 0 || secs < bestMiss) bestMiss = secs;
+    }
+    miss += bestMiss;
+    off += bestOff;
+  }
+  std::cout << "[Result] same table | a round of misses " << miss * 1e3
+            << " ms | cache off " << off * 1e3 << " ms\n";
+}
+
+// A value of SHOW CACHE, colours aside: "12", "1.0 MiB"
+static std::string value(const std::string& report, const std::string& name) {
+  std::string plain;
+  for (size_t i = 0; i < report.size(); ++i) {
+    if (report[i] == '\033') {
+      while (i < report.size() && report[i] != 'm') ++i;
+      continue;
+    }
+    plain += report[i];
+  }
+  std::istringstream in(plain);
+  std::string line;
+  while (std::getline(in, line)) {
+    std::istringstream cells(line);
+    std::string bar, word, number, unit;
+    cells >> bar >> word >> bar >> number >> unit;
+    if (word != name) continue;
+    bool sized = unit == "B" || unit == "KiB" || unit == "MiB";
+    return sized ? number + " " + unit : number;
+  }
+  return "";
+}
+
+static size_t counter(const std::string& report, const std::string& name) {
+  return static_cast<size_t>(std::atol(value(report, name).c_str()));
+}
+
+// Bytes from SHOW CACHE's "512 B", "3.5 KiB", "1.0 MiB"
+static double bytesOf(const std::string& text) {
+  double n = std::atof(text.c_str());
+  if (text.find("MiB") != std::string::npos) return n * 1024 * 1024;
+  if (text.find("KiB") != std::string::npos) return n * 1024;
+  return n;
+}
+
+// Every result 50 rows of the same width: key k holds rows 50k..50k+49
+struct Keyed {
+  void columns(Database& db) {
+    db.addColumn("k", ColumnType::INTEGER);
+    db.addColumn("v", ColumnType::INTEGER);
+  }
+  void cells(size_t i, std::vector<std::string>& c) {
+    std::ostringstream k, v;
+    k << i / 50;
+    v << 1000000 + i;
+    c[0] = k.str();
+    c[1] = v.str();
+  }
+};
+
+// 400 distinct results, about 4 KiB each, through a 1 MiB cache
+static bool bounded(Executor& ex) {
+  double secs;
+  ex.addTable("keyed", makeTable(400 * 50, Keyed()));
+  run(ex, "SET CACHE 1", secs);
+  for (size_t i = 0; i < 400; ++i) {
+    std::ostringstream sql;
+    sql << "SELECT * FROM keyed WHERE k = " << i;
+    run(ex, sql.str(), secs);
+  }
+  std::string report = run(ex, "SHOW CACHE", secs);
+  std::string bytes = value(report, "Bytes"), limit = value(report, "Limit");
+  std::cout << "[Result] 1 MiB cache after 400 distinct SELECTs | "
+            << counter(report, "Entries") << " entries, " << bytes << " of "
+            << limit << ", " << counter(report, "Evicted")
+            << " evicted in all\n";
+  if (counter(report, "Evicted") == 0 || bytesOf(bytes) > bytesOf(limit)) {
+    std::cout << "[FAIL] the 1 MiB cache holds " << bytes << "\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t rows = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+  size_t rounds = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 20;
+
+  char dir[] = "/tmp/bench_cache.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  std::string base(dir);
+  std::string csv = base + "/trades.csv", more = base + "/more.csv";
+  Generator::writeCsv(csv, Generator::TRADES, rows);
+  Generator::writeCsv(more, Generator::TRADES, rows / 10, 7);
+
+  Executor cached, plain;
+  double secs, c, p;
+  run(cached, "LOAD '" + csv + "' AS t", secs);
+  run(plain, "LOAD '" + csv + "' AS t", secs);
+  run(plain, "SET CACHE 0", secs);
+
+  if (!round(cached, plain, "first round", c, p)) return 1;
+  std::cout << "[Result] " << rows << " rows, " << kStatements
+            << " statements | first round " << c * 1e3 << " ms (uncached "
+            << p * 1e3 << " ms)\n";
+  double hits = 0, misses = 0;
+  for (size_t r = 1; r < rounds; ++r) {
+    if (!round(cached, plain, "a repeated round", c, p)) return 1;
+    hits += c;
+    misses += p;
+  }
+  if (rounds > 1)
+    std::cout << "[Result] repeated rounds | cached "
+              << hits * 1e3 / static_cast<double>(rounds - 1)
+              << " ms | uncached "
+              << misses * 1e3 / static_cast<double>(rounds - 1)
+              << " ms a round (x" << misses / hits << ")\n";
+
+  if (!afterWrite(cached, plain,
+                  "INSERT INTO t (id, symbol, side, quantity, price) VALUES "
+                  "('0', 'BTC', 'BUY', '999', '99999999')") ||
+      !afterWrite(cached, plain,
+                  "UPDATE t SET price = '1' WHERE symbol = 'ETH' AND "
+                  "quantity > 900") ||
+      !afterWrite(cached, plain, "DELETE FROM t WHERE symbol = 'SOL' AND "
+                                 "quantity < 100") ||
+      !afterWrite(cached, plain, "ALTER t RENAME COLUMN quantity TO qty") ||
+      !afterWrite(cached, plain, "ALTER t RENAME COLUMN qty TO quantity") ||
+      !afterWrite(cached, plain, "LOAD '" + more + "' AS t"))
+    return 1;
+  run(cached, "STYLE matrix", secs);
+  run(plain, "STYLE matrix", secs);
+  if (!round(cached, plain, "after STYLE", c, p)) return 1;
+
+  std::string report = run(cached, "SHOW CACHE", secs);
+  std::cout << report << "\n";
+  if (counter(report, "Hits") == 0 || counter(report, "Stale") == 0) {
+    std::cout << "[FAIL] SHOW CACHE counted no hits or no stale entries\n";
+    return 1;
+  }
+  missCost(cached);
+  if (!bounded(cached)) return 1;
+
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_cache: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,118 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_compress.cpp                                 :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/08 15:02:31 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/08 15:06:14 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// COMPRESS on a price table shaped like data.csv (ID, a date every few
+// days, a random-walk rate with 0-2 decimals): bytes before and after,
+// then the same scans on the plain and the compressed copy, which must
+// print the same thing.
+//   bench_compress [rows=2000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// A random walk of rates over business-ish days, in data.csv's shape
+struct Rates {
+  unsigned long seed;
+  int64_t day;
+  long cents;
+  Rates() : seed(42), day(EncodedColumn::days(2009, 1, 2)), cents(30) {}
+  void columns(Database& db) const {
+    db.addColumn("ID", ColumnType::INTEGER);
+    db.addColumn("date", ColumnType::DATE);
+    db.addColumn("exchange_rate", ColumnType::DOUBLE);
+  }
+  void cells(size_t i, std::vector<std::string>& c) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    day += 1 + static_cast<int64_t>((seed >> 33) % 4);
+    cents += static_cast<long>((seed >> 40) % 2001) - 1000;
+    if (cents < 0) cents = -cents;
+    char id[32], rate[64];
+    std::snprintf(id, sizeof(id), "%lu", static_cast<unsigned long>(i + 1));
+    if (cents % 100 == 0)
+      std::snprintf(rate, sizeof(rate), "%ld", cents / 100);
+    else if (cents % 10 == 0)
+      std::snprintf(rate, sizeof(rate), "%.1f", cents / 100.0);
+    else
+      std::snprintf(rate, sizeof(rate), "%.2f", cents / 100.0);
+    c[0] = id;
+    c[1] = EncodedColumn::formatDay(day);
+    c[2] = rate;
+  }
+};
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+
+  Database plain = makeTable(n, Rates());
+  Database packed = plain;
+  size_t before = plain.table().bytes();
+  double start = now();
+  packed.table().compress();
+  double encodeSecs = now() - start;
+  size_t after = packed.table().bytes();
+  std::cout << "[Result] " << n << " rows | " << before / 1024 << " KiB -> "
+            << after / 1024 << " KiB (x"
+            << static_cast<double>(before) / static_cast<double>(after)
+            << ") | encode " << encodeSecs * 1e3 << " ms\n";
+  if (before < after * 10) {
+    std::cout << "[FAIL] less than 10x smaller\n";
+    return 1;
+  }
+
+  Executor ex;
+  ex.addTable("p", plain);
+  ex.addTable("c", packed);
+  double secs;
+  run(ex, "SET CACHE 0", secs);  // time the scans, not result cache hits
+  static const char* queries[] = {
+      "SUM exchange_rate FROM %s",
+      "AVG exchange_rate FROM %s WHERE date >= '2020-01-01'",
+      "COUNT %s WHERE exchange_rate > 500 AND date < '2030-06-15'",
+      "MAX ID FROM %s WHERE exchange_rate = 12.5",
+      "SELECT * FROM %s WHERE date = '2100-01-01' OR exchange_rate > 4000 "
+      "LIMIT 20",
+  };
+  for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); ++q) {
+    char p[256], c[256];
+    std::snprintf(p, sizeof(p), queries[q], "p");
+    std::snprintf(c, sizeof(c), queries[q], "c");
+    double plainSecs, packedSecs;
+    std::string a = run(ex, p, plainSecs);
+    std::string b = run(ex, c, packedSecs);
+    if (a != b) {
+      std::cout << "[FAIL] " << queries[q] << " differs when compressed\n";
+      return 1;
+    }
+    std::cout << "[Result] plain " << plainSecs * 1e3 << " ms | compressed "
+              << packedSecs * 1e3 << " ms | " << p << "\n";
+  }
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_compress: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
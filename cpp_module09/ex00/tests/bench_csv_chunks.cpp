@@ -0,0 +1,211 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_csv_chunks.cpp                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/13 16:05:51 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/13 17:41:20 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// CSV::Document and Database loading from a mapped file cut into chunks
+// against the stream loaders, on a large trades file at several thread
+// counts.  Both must give the same rows in the same order.  A small file
+// full of quoted fields, escapes, empty lines, CRLF and newlines inside
+// quotes is then cut at every chunk size from 1 byte up: each cut must
+// give the records the stream loader reads, with and without
+// multilineQuotes, under the default, RFC 4180 and strict quote rules.
+//   bench_csv_chunks [rows=1000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/Database_utils.hpp"
+
+static bool sameDocument(const CSV::Document& a, const CSV::Document& b) {
+  if (a.headers() != b.headers() || a.rowCount() != b.rowCount())
+    return false;
+  for (size_t c = 0; c < a.headers().size(); ++c)
+    if (a.getColumnIndex(a.headers()[c]) != b.getColumnIndex(a.headers()[c]))
+      return false;
+  for (size_t i = 0; i < a.rowCount(); ++i)
+    if (a.rows()[i].values() != b.rows()[i].values()) return false;
+  return true;
+}
+
+static bool loadRun(const std::string& csv, size_t rows) {
+  CSV::Document expected;
+  double start = now();
+  {
+    std::ifstream in(csv.c_str());
+    expected.loadFromStream(in);
+  }
+  double stream = now() - start;
+  std::cout << "[Result] Document | " << rows << " rows | stream "
+            << stream * 1e3 << " ms";
+  size_t counts[] = {1, 2, 4, 8};
+  for (size_t t = 0; t < 4; ++t) {
+    CSV::Document doc;
+    start = now();
+    CsvChunks::load(doc, csv, CSV::Parser::Options(), counts[t]);
+    double secs = now() - start;
+    std::cout << " | " << counts[t] << " threads " << secs * 1e3 << " ms (x"
+              << stream / secs << ")";
+    if (!sameDocument(doc, expected)) {
+      std::cout << "\n[FAIL] Document differs at " << counts[t]
+                << " threads\n";
+      return false;
+    }
+  }
+  std::cout << "\n";
+
+  for (int header = 1; header >= 0; --header) {
+    RenderConfig cfg;
+    for (int id = 1; id >= 0; --id) {
+      cfg.autoIncrementId = id != 0;
+      start = now();
+      std::ifstream in(csv.c_str());
+      Table streamed = CsvParser::parse(in, header != 0, cfg);
+      stream = now() - start;
+      start = now();
+      Table chunked = CsvParser::parse(csv, header != 0, cfg);
+      double secs = now() - start;
+      std::cout << "[Result] Table | header " << header << " id " << id
+                << " | stream " << stream * 1e3 << " ms | chunks "
+                << secs * 1e3 << " ms (x" << stream / secs << ")\n";
+      if (!sameTable(streamed, chunked)) {
+        std::cout << "[FAIL] Database::loadFromCsv differs\n";
+        return false;
+      }
+    }
+  }
+  return true;
+}
+
+struct Records : CsvChunks::Job {
+  std::vector<std::vector<std::string> > chunks;
+  void record(size_t chunk, const std::string& record) {
+    chunks[chunk].push_back(record);
+  }
+};
+
+// The records getline (+ joinLines) reads after the header
+static std::vector<std::string> streamRecords(const std::string& text,
+                                              const CSV::Parser& parser) {
+  std::istringstream in(text);
+  std::vector<std::string> out;
+  std::string line;
+  bool header = true;
+  while (std::getline(in, line)) {
+    parser.joinLines(in, line);
+    if (!header) out.push_back(line);
+    header = false;
+  }
+  return out;
+}
+
+static bool cutRun(const std::string& path, const std::string& text,
+                   const char* what, CSV::Parser::Options options) {
+  for (int multiline = 0; multiline < 2; ++multiline) {
+    options.multilineQuotes = multiline != 0;
+    CsvChunks chunks(options);
+    if (!chunks.open(path)) return false;
+    std::vector<std::string> expected =
+        streamRecords(text, chunks.parser());
+    size_t begin = 0;
+    std::string header;
+    chunks.record(begin, header);
+    MorselPool pool(3);
+    for (size_t bytes = 1; bytes <= text.size(); ++bytes) {
+      chunks.split(begin, pool, bytes);
+      Records job;
+      job.chunks.resize(chunks.count());
+      chunks.parse(pool, job);
+      std::vector<std::string> got;
+      for (size_t k = 0; k < job.chunks.size(); ++k)
+        got.insert(got.end(), job.chunks[k].begin(), job.chunks[k].end());
+      if (got != expected) {
+        std::cout << "[FAIL] " << what << (multiline ? " multiline" : "")
+                  << ": records differ with " << bytes << "-byte chunks\n";
+        return false;
+      }
+    }
+    std::cout << "[Result] " << what << (multiline ? " multiline" : "")
+              << " | " << expected.size() << " records | every cut agrees\n";
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t rows = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+
+  char dir[] = "/tmp/bench_csv_chunks.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  std::string base(dir);
+  std::string csv = base + "/trades.csv", tricky = base + "/tricky.csv";
+
+  Generator::writeCsv(csv, Generator::TRADES, rows);
+  if (!loadRun(csv, rows)) return 1;
+
+  std::string text =
+      "id,name,note\r\n"
+      "1,\"Smith, John\",\"said \"\"hi\"\"\"\n"
+      "\n"
+      "2,plain,\"two\nlines\"\n"
+      "3,\"esc \\\" quote\",\"\"\"\"\n"
+      "4,\"open\n\nstill \"\"open\"\"\n, done\",x\r\n"
+      "5, spaced , \"a\",\"\"\n"
+      "\"\"\"\n"
+      "6,\"\",\"\"\"\"\"\"\n"
+      "7,last\",\"one\n"
+      "8,\"no end";
+  {
+    std::ofstream out(tricky.c_str());
+    out << text;
+  }
+  CSV::Parser::Options strict;
+  strict.strictQuotes = true;
+  if (!cutRun(tricky, text, "default", CSV::Parser::Options()) ||
+      !cutRun(tricky, text, "rfc4180", CSV::Parser::Options::RFC4180()) ||
+      !cutRun(tricky, text, "strict", strict))
+    return 1;
+
+  // The whole loaders on the same file
+  for (int multiline = 0; multiline < 2; ++multiline) {
+    CSV::Parser::Options options;
+    options.multilineQuotes = multiline != 0;
+    CSV::Document expected, doc;
+    std::ifstream in(tricky.c_str());
+    expected.loadFromStream(in, options);
+    CsvChunks::load(doc, tricky, options, 4);
+    if (!sameDocument(doc, expected)) {
+      std::cout << "[FAIL] tricky Document differs\n";
+      return 1;
+    }
+  }
+
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_csv_chunks: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,309 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_csv_writer.cpp                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/14 17:20:09 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/14 18:40:31 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// CSV::Document saving through CSV::Writer, serially and on threads with
+// CsvChunks::save, against the escape-a-string-per-field ostream loop it
+// replaced, on a large trades document.  Every file must be the same
+// bytes.  Formatting alone into memory is timed against writing the same
+// bytes to disk, to see which one bounds an export.  Awkward fields must
+// read back as they were written, and save again to the same bytes, and
+// Writer::integer / number must give strtol / strtod their value back.
+//   bench_csv_writer [rows=1000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/Database_utils.hpp"
+
+static std::string slurp(const std::string& path) {
+  std::ifstream in(path.c_str(), std::ios::binary);
+  std::ostringstream s;
+  s << in.rdbuf();
+  return s.str();
+}
+
+// saveToStream as it was: a new escaped string per field, one << at a time
+static std::string legacyEscape(const std::string& field,
+                                const CSV::Parser::Options& options) {
+  bool needsQuotes = (field.find(options.delimiter) != std::string::npos ||
+                      field.find(options.quote) != std::string::npos ||
+                      field.find('\n') != std::string::npos);
+  if (!needsQuotes) return field;
+  std::string escaped;
+  escaped += options.quote;
+  for (size_t i = 0; i < field.size(); ++i) {
+    char c = field[i];
+    if (c == options.quote) {
+      escaped += options.quote;
+      escaped += options.quote;
+    } else
+      escaped += c;
+  }
+  escaped += options.quote;
+  return escaped;
+}
+
+static void legacySave(const CSV::Document& doc, std::ostream& stream,
+                       const CSV::Parser::Options& options) {
+  const std::vector<std::string>& headers = doc.headers();
+  for (size_t i = 0; i < headers.size(); ++i) {
+    stream << legacyEscape(headers[i], options);
+    if (i < headers.size() - 1) stream << options.delimiter;
+  }
+  stream << "\n";
+  for (size_t ri = 0; ri < doc.rowCount(); ++ri) {
+    const CSV::Row& row = doc.rows()[ri];
+    for (size_t i = 0; i < row.size(); ++i) {
+      stream << legacyEscape(row[i], options);
+      if (i < row.size() - 1) stream << options.delimiter;
+    }
+    stream << "\n";
+  }
+}
+
+static bool saveRun(const std::string& base, const CSV::Document& doc) {
+  CSV::Parser::Options options;
+  std::string legacy = base + "/legacy.csv", out = base + "/out.csv";
+  double start = now();
+  {
+    std::ofstream f(legacy.c_str());
+    legacySave(doc, f, options);
+  }
+  double legacySecs = now() - start;
+  std::string expected = slurp(legacy);
+  double mb = static_cast<double>(expected.size()) / 1e6;
+  std::cout << "[Result] save | " << doc.rowCount() << " rows | " << mb
+            << " MB | per-field ostream " << legacySecs * 1e3 << " ms";
+
+  start = now();
+  doc.save(out);
+  double secs = now() - start;
+  std::cout << " | Writer " << secs * 1e3 << " ms (x" << legacySecs / secs
+            << ")";
+  if (slurp(out) != expected) {
+    std::cout << "\n[FAIL] saveToStream changed the bytes\n";
+    return false;
+  }
+  size_t counts[] = {1, 2, 4, 0};
+  for (size_t t = 0; t < 4; ++t) {
+    start = now();
+    if (!CsvChunks::save(doc, out, options, counts[t])) return false;
+    secs = now() - start;
+    size_t threads = counts[t] ? counts[t] : MorselPool::hardwareThreads();
+    std::cout << " | " << (counts[t] ? "" : "all ") << threads
+              << " threads " << secs * 1e3 << " ms";
+    if (slurp(out) != expected) {
+      std::cout << "\n[FAIL] CsvChunks::save changed the bytes at "
+                << threads << " threads\n";
+      return false;
+    }
+  }
+  std::cout << "\n";
+
+  // formatting alone, against the disk alone
+  std::string text;
+  start = now();
+  {
+    CSV::Writer w(text, options);
+    w.row(doc.headers());
+    for (size_t i = 0; i < doc.rowCount(); ++i) w.row(doc.rows()[i].values());
+  }
+  double format = now() - start;
+  start = now();
+  {
+    std::ofstream f(out.c_str(), std::ios::binary);
+    f.write(text.data(), static_cast<std::streamsize>(text.size()));
+  }
+  double disk = now() - start;
+  std::cout << "[Result] format only " << mb / format << " MB/s | write only "
+            << mb / disk << " MB/s\n";
+  if (text != expected) {
+    std::cout << "[FAIL] in-memory Writer changed the bytes\n";
+    return false;
+  }
+  return true;
+}
+
+// Awkward fields written, read back and written again
+static bool roundTrip(const std::string& base) {
+  const char* cells[] = {"plain",          "a,b",        "say \"hi\"",
+                         "\"",             "\"\"",       "two\nlines",
+                         "",               "tab\there",  "ends with \"",
+                         "\",\n\"",        "caf\xc3\xa9", "0.1",
+                         "x\ny\n\nz",      ",",          "1e+20",
+                         "a long field with nothing to quote at all, really"};
+  size_t n = sizeof(cells) / sizeof(cells[0]);
+  CSV::Document doc;
+  std::vector<std::string> headers;
+  headers.push_back("id");
+  headers.push_back("text");
+  headers.push_back("quoted, header");
+  doc.setHeaders(headers);
+  for (size_t i = 0; i < n * n; ++i) {
+    std::vector<std::string> v;
+    v.push_back(cells[i / n]);
+    v.push_back(cells[i % n]);
+    v.push_back(std::string(cells[i % n]) + cells[i / n]);
+    doc.addRow(CSV::Row(v));
+  }
+  // RFC4180() reads a field opening with "" as an escaped quote
+  CSV::Parser::Options options;
+  options.multilineQuotes = true;
+  options.trimWhitespace = false;
+  options.skipEmptyLines = false;
+  std::string path = base + "/round.csv", again = base + "/again.csv";
+  if (!CsvChunks::save(doc, path, options, 3)) return false;
+  CSV::Document back;
+  if (!back.load(path, options) || back.headers() != doc.headers() ||
+      back.rowCount() != doc.rowCount()) {
+    std::cout << "[FAIL] round trip: wrong shape\n";
+    return false;
+  }
+  for (size_t i = 0; i < doc.rowCount(); ++i)
+    if (back.rows()[i].values() != doc.rows()[i].values()) {
+      std::cout << "[FAIL] round trip: row " << i << " differs\n";
+      return false;
+    }
+  back.save(again, options);
+  if (slurp(again) != slurp(path)) {
+    std::cout << "[FAIL] round trip: saving again changed the bytes\n";
+    return false;
+  }
+  std::cout << "[Result] round trip | " << doc.rowCount()
+            << " awkward rows read back and saved to the same bytes\n";
+  return true;
+}
+
+// Writer::number against strtod, timed against "%.17g"
+static bool numberRun(const char* what, const std::vector<double>& values) {
+  std::string text, printed;
+  double start = now();
+  {
+    CSV::Writer w(text);
+    for (size_t i = 0; i < values.size(); ++i) {
+      w.number(values[i]);
+      w.endRow();
+    }
+  }
+  double secs = now() - start;
+  start = now();
+  for (size_t i = 0; i < values.size(); ++i) {
+    char buf[32];
+    std::snprintf(buf, sizeof(buf), "%.17g\n", values[i]);
+    printed += buf;
+  }
+  double snprintfSecs = now() - start;
+  std::istringstream in(text);
+  std::string line;
+  for (size_t i = 0; std::getline(in, line); ++i)
+    if (std::strtod(line.c_str(), NULL) != values[i]) {
+      std::cout << "[FAIL] number: '" << line << "' is not " << values[i]
+                << "\n";
+      return false;
+    }
+  std::cout << "[Result] number | " << what << " | " << values.size()
+            << " | " << secs * 1e3 << " ms (%.17g " << snprintfSecs * 1e3
+            << " ms) | " << text.size() << " bytes (" << printed.size()
+            << ")\n";
+  return true;
+}
+
+// Writer::integer against strtol
+static bool integerRun(const std::vector<long>& values) {
+  std::string text;
+  double start = now();
+  {
+    CSV::Writer w(text);
+    for (size_t i = 0; i < values.size(); ++i) {
+      w.integer(values[i]);
+      w.endRow();
+    }
+  }
+  double secs = now() - start;
+  std::istringstream in(text);
+  std::string line;
+  for (size_t i = 0; std::getline(in, line); ++i)
+    if (std::strtol(line.c_str(), NULL, 10) != values[i]) {
+      std::cout << "[FAIL] integer: '" << line << "' is not " << values[i]
+                << "\n";
+      return false;
+    }
+  std::cout << "[Result] integer | " << values.size() << " | " << secs * 1e3
+            << " ms\n";
+  return true;
+}
+
+static bool numbers() {
+  std::vector<double> prices, ratios, bits;
+  std::vector<long> longs;
+  double special[] = {0.0, -0.0, 0.1, -0.05, 1e-7, 123456789.125, 1e20,
+                      -1.7976931348623157e308, 4.9e-324, 9007199254740993.0,
+                      0.30000000000000004, 100.0, 2.5e-10};
+  bits.assign(special, special + sizeof(special) / sizeof(special[0]));
+  longs.push_back(0);
+  longs.push_back(-1);
+  longs.push_back(9223372036854775807L);
+  longs.push_back(-9223372036854775807L - 1);
+  unsigned long h = 88172645463325252UL;
+  for (size_t i = 0; i < 1000000; ++i) {
+    h ^= h << 13;
+    h ^= h >> 7;
+    h ^= h << 17;
+    longs.push_back(static_cast<long>(h >> (h % 48)));
+    prices.push_back(static_cast<double>(h % 10000000) / 100.0);
+    ratios.push_back(static_cast<double>(h % 1000000) / 7.0 *
+                     (i % 2 ? 1 : -1e-9));
+    double d;
+    unsigned long finite = h & 0x7FEFFFFFFFFFFFFFUL;
+    std::memcpy(&d, &finite, sizeof(d));
+    bits.push_back(d);
+  }
+  return numberRun("prices", prices) && numberRun("ratios", ratios) &&
+         numberRun("any bits", bits) && integerRun(longs);
+}
+
+int main(int argc, char** argv) {
+  size_t rows = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+
+  char dir[] = "/tmp/bench_csv_writer.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  std::string base(dir);
+  std::string csv = base + "/trades.csv";
+  Generator::writeCsv(csv, Generator::TRADES, rows);
+  CSV::Document doc;
+  CsvChunks::load(doc, csv);
+
+  if (!saveRun(base, doc) || !roundTrip(base) || !numbers()) return 1;
+
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_csv_writer: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,203 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_decompress.cpp                               :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/14 13:02:36 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/14 15:31:09 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// A trades CSV compressed by the gzip and zstd tools, as one member and
+// as many members back to back, read through DecompressStream at 1 and
+// at all threads.  The text must match the plain file byte for byte.
+// Database::loadFromCsv and Document loading straight from the archive
+// must give the plain file's rows; loadFromCsv is timed next to
+// decompressing to a temp file first, which is not slower on tmpfs.
+// A truncated file (half of it) and trailing garbage must throw,
+// trailing zeros are padding, and a reader may stop early.
+// Formats whose tool (or library) is missing here are skipped.
+//   bench_decompress [rows=1000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/Database_utils.hpp"
+
+static bool sh(const std::string& cmd) { return std::system(cmd.c_str()) == 0; }
+
+static std::string slurp(std::istream& in) {
+  std::ostringstream s;
+  s << in.rdbuf();
+  return s.str();
+}
+
+// Whether reading path through DecompressStream throws
+static bool rejects(const std::string& path) {
+  try {
+    DecompressStream in(path);
+    slurp(in.stream());
+    in.check();
+  } catch (const std::exception& e) {
+    std::cout << "[Result] rejected: " << e.what() << "\n";
+    return true;
+  }
+  return false;
+}
+
+static bool archiveRun(const std::string& what, const std::string& archive,
+                       const std::string& unpack, const std::string& csv,
+                       const std::string& plain, Table& expected) {
+  std::ifstream f(archive.c_str(), std::ios::binary | std::ios::ate);
+  double packed = static_cast<double>(f.tellg());
+  std::cout << "[Result] " << what << " | "
+            << static_cast<double>(plain.size()) / packed << ":1";
+  size_t counts[] = {1, 0};
+  for (size_t t = 0; t < 2; ++t) {
+    double start = now();
+    DecompressStream in(archive, counts[t]);
+    std::string text = slurp(in.stream());
+    in.check();
+    double secs = now() - start;
+    std::cout << " | " << (counts[t] ? "1 thread " : "all threads ")
+              << static_cast<double>(text.size()) / secs / 1e6 << " MB/s";
+    if (text != plain) {
+      std::cout << "\n[FAIL] " << what << ": decompressed text differs\n";
+      return false;
+    }
+  }
+
+  std::string tmp = csv + ".tmp";
+  double start = now();
+  if (!sh(unpack + " '" + archive + "' > '" + tmp + "'")) return false;
+  Database viaDisk;
+  viaDisk.loadFromCsv(tmp);
+  double diskSecs = now() - start;
+  ::unlink(tmp.c_str());
+  start = now();
+  Database direct;
+  direct.loadFromCsv(archive);
+  double secs = now() - start;
+  std::cout << " | loadFromCsv " << secs * 1e3 << " ms (temp file "
+            << diskSecs * 1e3 << " ms)\n";
+  if (!sameTable(direct.table(), expected)) {
+    std::cout << "[FAIL] " << what << ": loadFromCsv differs\n";
+    return false;
+  }
+  CSV::Document doc, plainDoc;
+  CsvChunks::load(doc, archive);
+  CsvChunks::load(plainDoc, csv);
+  if (doc.headers() != plainDoc.headers() ||
+      doc.rowCount() != plainDoc.rowCount() ||
+      doc.rows().back().values() != plainDoc.rows().back().values()) {
+    std::cout << "[FAIL] " << what << ": Document differs\n";
+    return false;
+  }
+  return true;
+}
+
+// Single and multi-member archives of csv made by `tool`, read back
+static bool formatRun(const std::string& base, const std::string& csv,
+                      const std::string& plain, Table& expected,
+                      const std::string& tool, const std::string& ext) {
+  std::string one = base + "/one" + ext, many = base + "/many" + ext;
+  std::string pack = tool + " -c", unpack = tool + " -dc";
+  if (!sh(pack + " '" + csv + "' > '" + one + "'") ||
+      !sh("cd '" + base + "' && split -b 1000000 '" + csv +
+          "' part. && for f in part.*; do " + pack + " \"$f\"; done > '" +
+          many + "' && rm -f part.*"))
+    return false;
+  if (!archiveRun(tool + " one member", one, unpack, csv, plain, expected) ||
+      !archiveRun(tool + " many members", many, unpack, csv, plain,
+                  expected))
+    return false;
+
+  // a reader that stops early must not leave the producer stuck
+  {
+    DecompressStream in(many);
+    std::string header;
+    std::getline(in.stream(), header);
+  }
+
+  // padding is fine, garbage or a cut archive is not
+  std::string padded = base + "/padded" + ext;
+  sh("cp '" + many + "' '" + padded + "' && head -c 4096 /dev/zero >> '" +
+     padded + "'");
+  {
+    DecompressStream in(padded);
+    if (slurp(in.stream()) != plain) {
+      std::cout << "[FAIL] " << tool << ": padded archive differs\n";
+      return false;
+    }
+    in.check();
+  }
+  std::string junk = base + "/junk" + ext, cut = base + "/cut" + ext;
+  sh("cp '" + many + "' '" + junk + "' && printf 'junk' >> '" + junk + "'");
+  std::ifstream whole(one.c_str(), std::ios::binary | std::ios::ate);
+  std::ostringstream half;
+  half << static_cast<long>(whole.tellg()) / 2;
+  sh("head -c " + half.str() + " '" + one + "' > '" + cut + "'");
+  if (!rejects(junk) || !rejects(cut)) {
+    std::cout << "[FAIL] " << tool << ": a damaged archive was accepted\n";
+    return false;
+  }
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t rows = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+
+  char dir[] = "/tmp/bench_decompress.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  std::string base(dir);
+  std::string csv = base + "/trades.csv";
+  Generator::writeCsv(csv, Generator::TRADES, rows);
+  std::string plain;
+  {
+    std::ifstream in(csv.c_str());
+    plain = slurp(in);
+  }
+  Database expected;
+  expected.loadFromCsv(csv);
+
+#if HAVE_ZLIB
+  if (!sh("command -v gzip > /dev/null"))
+    std::cout << "[Result] no gzip tool here\n";
+  else if (!formatRun(base, csv, plain, expected.table(), "gzip", ".gz"))
+    return 1;
+#else
+  std::cout << "[Result] built without zlib: gzip skipped\n";
+#endif
+  if (!Zstd::get())
+    std::cout << "[Result] no libzstd here\n";
+  else if (!sh("command -v zstd > /dev/null"))
+    std::cout << "[Result] no zstd tool here\n";
+  else if (!formatRun(base, csv, plain, expected.table(), "zstd -q",
+                      ".zst"))
+    return 1;
+
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_decompress: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
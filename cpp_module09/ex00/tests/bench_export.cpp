@@ -0,0 +1,146 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_export.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/07 09:41:18 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/07 09:44:55 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// EXPORT ... TO CSV streamed through FdWriter at 1 thread and at the CPU
+// count, against the per-cell getValue + ofstream loop it replaced.  Wall
+// time, peak RSS growth, and every file must be byte-identical.
+//   bench_export [rows=2000000] [dir=/tmp]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <sys/resource.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// Peak resident set so far, in MiB
+static double peakMb() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return static_cast<double>(ru.ru_maxrss) / 1024.0;
+}
+
+struct Notes {
+  void columns(Database& db) const {
+    db.addColumn("date");
+    db.addColumn("price", ColumnType::DOUBLE);
+    db.addColumn("note");
+  }
+  void cells(size_t i, std::vector<std::string>& c) const {
+    std::ostringstream d, p;
+    d << 2010 + i % 14 << "-01-" << 10 + i % 19;
+    p << (i * 7919) % 100000 / 100.0;
+    c[0] = d.str();
+    c[1] = p.str();
+    c[2] = i % 7 ? "plain" : "a, \"quoted\" one";
+  }
+};
+
+// The exporter before streaming: name lookup per cell, ofstream, and the
+// quoting fixed to match (inner quotes doubled)
+static void oldCsv(const Table& table, const std::string& path) {
+  std::ofstream file(path.c_str());
+  const std::vector<Column>& cols = table.columns();
+  for (size_t i = 0; i < cols.size(); ++i)
+    file << cols[i].name() << (i + 1 < cols.size() ? "," : "\n");
+  const std::vector<Row>& rows = table.rows();
+  for (size_t r = 0; r < rows.size(); ++r) {
+    for (size_t i = 0; i < cols.size(); ++i) {
+      std::string value = rows[r].getValue(cols[i].name());
+      if (value.find_first_of(",\"\r\n") != std::string::npos) {
+        std::string q = "\"";
+        for (size_t k = 0; k < value.size(); ++k) {
+          if (value[k] == '"') q += '"';
+          q += value[k];
+        }
+        value = q + "\"";
+      }
+      file << value << (i + 1 < cols.size() ? "," : "\n");
+    }
+  }
+}
+
+static std::string slurp(const std::string& path) {
+  std::ifstream f(path.c_str(), std::ios::binary);
+  std::ostringstream s;
+  s << f.rdbuf();
+  return s.str();
+}
+
+static double exportWith(Executor& ex, size_t threads,
+                         const std::string& path) {
+  std::ostringstream set, exp;
+  set << "SET THREADS " << threads;
+  exp << "EXPORT t TO CSV '" << path << "'";
+  const std::string sql[] = {set.str(), exp.str()};
+  double secs = 0;
+  for (size_t i = 0; i < 2; ++i) run(ex, sql[i], secs);
+  return secs;
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+  std::string dir = argc > 2 ? argv[2] : "/tmp";
+  std::string streamed = dir + "/bench_export_stream.csv";
+  std::string parallel = dir + "/bench_export_parallel.csv";
+  std::string old = dir + "/bench_export_old.csv";
+
+  Database db = makeTable(n, Notes());
+  Executor ex;
+  ex.addTable("t", db);
+  double base = peakMb();
+
+  // Streaming first, so the peak it reports is not the old loop's
+  double secs = exportWith(ex, 1, streamed);
+  std::cout << "[Result] streamed, 1 thread | " << n << " rows | "
+            << secs * 1e3 << " ms | peak RSS +" << peakMb() - base
+            << " MiB\n";
+  size_t threads = MorselPool::hardwareThreads();
+  secs = exportWith(ex, threads, parallel);
+  std::cout << "[Result] streamed, " << threads << " thread"
+            << (threads > 1 ? "s" : "") << " | " << secs * 1e3
+            << " ms | peak RSS +" << peakMb() - base << " MiB\n";
+
+  double start = now();
+  oldCsv(db.table(), old);
+  std::cout << "[Result] getValue + ofstream | " << (now() - start) * 1e3
+            << " ms\n";
+
+  std::string a = slurp(streamed);
+  if (a != slurp(parallel) || a != slurp(old)) {
+    std::cout << "[FAIL] exports differ\n";
+    return 1;
+  }
+  std::cout << "[Result] " << a.size() << " bytes, identical\n";
+  std::remove(streamed.c_str());
+  std::remove(parallel.c_str());
+  std::remove(old.c_str());
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_export: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
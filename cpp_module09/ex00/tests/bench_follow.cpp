@@ -0,0 +1,232 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_follow.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/11 13:10:27 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/11 14:02:55 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// A PriceFeed following a CSV that this process appends to in batches,
+// with inotify and then by polling, while a reader thread keeps looking
+// dates up: the cost of a lookup under a moving feed, and how long an
+// appended row takes to become visible.  Afterwards lookups must answer
+// as a fresh loadDatabase does, the followed table must equal loadFromCsv,
+// and out-of-order rows, a truncation and a replaced file must be seen.
+//   bench_follow [batches=200] [rows per batch=500]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <pthread.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "BitCoinExchange.hpp"
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+
+static std::string row(size_t i) {
+  std::ostringstream s;
+  s << day(i, 1800) << "," << static_cast<double>(i * 37 % 99991) / 10
+    << "\n";
+  return s.str();
+}
+
+static void append(const std::string& path, const std::string& text) {
+  std::ofstream out(path.c_str(), std::ios::app);
+  out << text;
+}
+
+static std::string render(const Database& db) { return db.render(); }
+
+// Waits for the feed to reach rows dates; seconds taken, < 0 on timeout
+static double waitFor(PriceFeed& feed, size_t reader, size_t rows) {
+  double start = now();
+  for (;;) {
+    feed.online(reader);
+    size_t n = feed.size();
+    feed.offline(reader);
+    if (n == rows) return now() - start;
+    if (now() - start > 5) return -1;
+    usleep(50);
+  }
+}
+
+struct Reader {
+  PriceFeed* feed;
+  int stop;
+  size_t lookups;
+  size_t misses;
+};
+
+// Looks dates up until stop, going quiescent every 1024 lookups
+static void* readerThread(void* arg) {
+  Reader* r = static_cast<Reader*>(arg);
+  size_t slot = r->feed->addReader();
+  r->feed->online(slot);
+  for (size_t i = 0; !__atomic_load_n(&r->stop, __ATOMIC_RELAXED);
+       ++i) {
+    double rate;
+    if (!r->feed->lookup(day(i % 100000, 1800), rate)) ++r->misses;
+    ++r->lookups;
+    if ((i & 1023) == 0) r->feed->quiescent(slot);
+  }
+  r->feed->offline(slot);
+  return NULL;
+}
+
+static bool followRun(const std::string& base, bool inotify, size_t batches,
+                      size_t perBatch) {
+  std::string csv = base + "/data.csv", input = base + "/input.txt";
+  {
+    std::ofstream out(csv.c_str());
+    out << "date,exchange_rate\n";
+    for (size_t i = 0; i < 1000; ++i) out << row(i);
+  }
+  PriceFeed feed(csv, inotify);
+  feed.start();
+  if (inotify && !feed.inotify()) std::cout << "[Result] no inotify here\n";
+  size_t me = feed.addReader();
+
+  Reader reader;
+  reader.feed = &feed;
+  reader.stop = 0;
+  reader.lookups = reader.misses = 0;
+  pthread_t thread;
+  pthread_create(&thread, NULL, readerThread, &reader);
+
+  size_t rows = 1000;
+  double worst = 0, total = 0, start = now();
+  for (size_t b = 0; b < batches; ++b) {
+    std::string text;
+    for (size_t i = 0; i < perBatch; ++i) text += row(rows + i);
+    // a line cut in two must not be read before its end arrives
+    size_t cut = text.size() - 7;
+    append(csv, text.substr(0, cut));
+    append(csv, text.substr(cut));
+    rows += perBatch;
+    double t = waitFor(feed, me, rows);
+    if (t < 0) {
+      std::cout << "[FAIL] " << rows << " rows never showed up\n";
+      return false;
+    }
+    total += t;
+    if (t > worst) worst = t;
+  }
+  double secs = now() - start;
+  __atomic_store_n(&reader.stop, 1, __ATOMIC_RELAXED);
+  pthread_join(thread, NULL);
+  feed.online(me);
+  std::cout << "[Result] " << (inotify ? "inotify" : "polling") << " | "
+            << batches << " x " << perBatch << " rows | visible after "
+            << total * 1e3 / static_cast<double>(batches) << " ms avg, "
+            << worst * 1e3 << " ms worst | lookup "
+            << secs * 1e9 / static_cast<double>(reader.lookups) << " ns | "
+            << feed.runs() << " runs\n";
+
+  {
+    std::ofstream in(input.c_str());
+    in << "date | value\n";
+    for (size_t i = 0; i < 2000; ++i)
+      in << day(i * 997 % (rows + 50), 1800) << " | " << i % 10 << "\n";
+    in << "1799-12-31 | 1\n";
+  }
+  BitcoinExchange followed;
+  followed.follow(feed);
+  BitcoinExchange loaded(csv);
+  if (answers(followed, input) != answers(loaded, input)) {
+    std::cout << "[FAIL] followed lookups differ from loadDatabase\n";
+    return false;
+  }
+  Database table, expected;
+  PriceFeed::Cursor cursor;
+  feed.apply(table, cursor);
+  expected.loadFromCsv(csv);
+  if (render(table) != render(expected)) {
+    std::cout << "[FAIL] followed table differs from loadFromCsv\n";
+    return false;
+  }
+
+  // Rows for earlier dates: a new first one, and a new rate for day 7
+  feed.offline(me);
+  append(csv, "1799-06-01,4\n" + day(7, 1800) + ",123.5\n");
+  if (waitFor(feed, me, ++rows) < 0) {
+    std::cout << "[FAIL] out-of-order rows never showed up\n";
+    return false;
+  }
+  feed.online(me);
+  feed.apply(table, cursor);
+  expected.loadFromCsv(csv);
+  double rate = 0;
+  if (!feed.lookup(day(7, 1800), rate) || rate != 123.5 ||
+      answers(followed, input) != answers(BitcoinExchange(csv), input) ||
+      render(table) != render(expected)) {
+    std::cout << "[FAIL] an out-of-order row was not merged\n";
+    return false;
+  }
+  feed.offline(me);
+
+  // Truncated, then replaced by another file
+  {
+    std::ofstream out(csv.c_str());
+    out << "date,exchange_rate\n" << row(3);
+  }
+  if (waitFor(feed, me, 1) < 0) {
+    std::cout << "[FAIL] truncation not seen\n";
+    return false;
+  }
+  {
+    std::string tmp = csv + ".new";
+    std::ofstream out(tmp.c_str());
+    out << "date,exchange_rate\n" << row(1) << row(2);
+    out.close();
+    std::rename(tmp.c_str(), csv.c_str());
+  }
+  if (waitFor(feed, me, 2) < 0) {
+    std::cout << "[FAIL] replaced file not seen\n";
+    return false;
+  }
+  feed.online(me);
+  feed.apply(table, cursor);
+  expected.loadFromCsv(csv);
+  bool same = render(table) == render(expected) &&
+              answers(followed, input) == answers(BitcoinExchange(csv), input);
+  feed.offline(me);
+  if (!same) {
+    std::cout << "[FAIL] replaced file answered from the old one\n";
+    return false;
+  }
+  feed.stop();
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t batches = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 200;
+  size_t perBatch = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 500;
+
+  char dir[] = "/tmp/bench_follow.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  if (!followRun(dir, true, batches, perBatch) ||
+      !followRun(dir, false, batches / 20 + 1, perBatch))
+    return 1;
+  std::string cmd = std::string("rm -rf ") + dir;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_follow: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,108 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_index.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/09 11:02:14 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/09 11:25:40 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Startup cost of BitcoinExchange: parsing the CSV every time against
+// loadCached(), first when it builds the shared index and then when it only
+// maps it, for growing price histories.  Every way of loading must answer
+// the same input file identically, and touching the CSV must rebuild.
+//   bench_index [max rows=1000000]
+// Build with `make bench`.
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+
+#include "BitCoinExchange.hpp"
+#include "tests/bench_util.hpp"
+
+// One row per day from 1700-01-01 (28-day months keep the dates valid)
+static void writeCsv(const std::string& path, size_t rows) {
+  std::ofstream out(path.c_str());
+  out << "date,exchange_rate\n";
+  for (size_t i = 0; i < rows; ++i)
+    out << day(i, 1700) << "," << static_cast<double>(i % 99991) / 100.0
+        << "\n";
+}
+
+int main(int argc, char** argv) {
+  size_t maxRows = argc > 1 ? static_cast<size_t>(std::atol(argv[1]))
+                            : 1000000;
+  char dir[] = "/tmp/bench_index.XXXXXX";
+  if (!mkdtemp(dir)) {
+    std::cout << "[FAIL] mkdtemp\n";
+    return 1;
+  }
+  setenv("BTC_INDEX_DIR", dir, 1);
+  std::string csv = std::string(dir) + "/data.csv";
+  std::string input = std::string(dir) + "/input.txt";
+
+  for (size_t rows = 1000; rows <= maxRows; rows *= 10) {
+    writeCsv(csv, rows);
+    {
+      std::ofstream in(input.c_str());
+      in << "date | value\n";
+      for (size_t i = 0; i < 200; ++i)
+        in << day(i * rows / 200 + i % 3, 1700) << " | " << i % 10 << "\n";
+      in << "1699-12-31 | 1\n2999-01-01 | 1\n";
+    }
+
+    double start = now();
+    BitcoinExchange parsed;
+    parsed.loadDatabase(csv);
+    double parseMs = (now() - start) * 1e3;
+
+    start = now();
+    BitcoinExchange built;
+    built.loadCached(csv);
+    double buildMs = (now() - start) * 1e3;
+
+    start = now();
+    BitcoinExchange mapped;
+    mapped.loadCached(csv);
+    double mapMs = (now() - start) * 1e3;
+
+    std::cout << "[Result] " << rows << " rows | parse " << parseMs
+              << " ms | build index " << buildMs << " ms | attach " << mapMs
+              << " ms\n";
+    std::string expected = answers(parsed, input);
+    if (answers(built, input) != expected ||
+        answers(mapped, input) != expected ||
+        answers(BitcoinExchange(mapped), input) != expected) {
+      std::cout << "[FAIL] answers differ at " << rows << " rows\n";
+      return 1;
+    }
+  }
+
+  // A changed CSV must not be answered from the old index
+  {
+    std::ofstream out(csv.c_str(), std::ios::app);
+    out << "2999-01-01,12345\n";
+  }
+  BitcoinExchange parsed;
+  parsed.loadDatabase(csv);
+  BitcoinExchange cached;
+  cached.loadCached(csv);
+  if (answers(cached, input) != answers(parsed, input)) {
+    std::cout << "[FAIL] stale index used after the CSV changed\n";
+    return 1;
+  }
+  std::cout << "[Result] changed CSV rebuilt the index\n";
+
+  std::string cmd = std::string("rm -rf ") + dir;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
@@ -0,0 +1,106 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_lexer.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/01 16:52:09 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/01 16:53:24 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Statements/sec through Lexer (+ Parser) for a scripted workload of many
+// short statements.  Build with `make bench` (needs the MySQLite engine).
+
+#include <ctime>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+static const char* kStatements[] = {
+    "SELECT date, exchange_rate FROM prices WHERE date >= 2021-01-01 AND "
+    "exchange_rate > 100 ORDER BY date DESC LIMIT 20",
+    "select * from employees where department = 'Engineering' limit 5",
+    "INSERT INTO prices (date, exchange_rate) VALUES ('2024-01-01', 42000.5)",
+    "UPDATE employees SET salary = 90000, title = 'Lead' WHERE id = 7",
+    "DELETE FROM sales WHERE region != 'EU' OR amount < 10",
+    "ALTER TABLE employees ADD COLUMN bonus DOUBLE",
+    "COUNT employees WHERE age > 30",
+    "AVG salary FROM employees WHERE department = 'Sales'",
+    "STATS exchange_rate FROM prices",
+    "EXPORT employees TO CSV 'out/employees.csv'",
+};
+static const size_t kStatementCount =
+    sizeof(kStatements) / sizeof(kStatements[0]);
+
+// Every keyword must resolve in any letter case, and near misses must not.
+static bool check_keywords() {
+  static const char* words[] = {"select", "FrOm", "databases", "BOOL",
+                                "markdown", "int", "real", "desc"};
+  static const char* misses[] = {"selects", "fro", "tablez", "x", "order_by"};
+  for (size_t i = 0; i < sizeof(words) / sizeof(words[0]); ++i) {
+    TK::Type t;
+    if (!Keywords::lookup(words[i], std::strlen(words[i]), t)) {
+      std::cout << "[FAIL] keyword not found: " << words[i] << "\n";
+      return false;
+    }
+  }
+  for (size_t i = 0; i < sizeof(misses) / sizeof(misses[0]); ++i) {
+    TK::Type t;
+    if (Keywords::lookup(misses[i], std::strlen(misses[i]), t)) {
+      std::cout << "[FAIL] false keyword match: " << misses[i] << "\n";
+      return false;
+    }
+  }
+  return true;
+}
+
+static double run(size_t rounds, bool parse, size_t* tokens_out) {
+  std::vector<std::string> inputs(kStatements, kStatements + kStatementCount);
+  size_t tokens = 0;
+  std::clock_t start = std::clock();
+  for (size_t r = 0; r < rounds; ++r) {
+    for (size_t i = 0; i < inputs.size(); ++i) {
+      Lexer lexer(inputs[i]);
+      std::vector<Token> toks = lexer.tokenize();
+      tokens += toks.size();
+      if (parse) {
+        Parser parser(toks);
+        AST::Statement stmt = parser.parse();
+        tokens += stmt.type == AST::STMT_UNKNOWN;
+      }
+    }
+  }
+  std::clock_t end = std::clock();
+  *tokens_out = tokens;
+  return static_cast<double>(end - start) / CLOCKS_PER_SEC;
+}
+
+int main(int argc, char** argv) {
+  size_t rounds = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 50000;
+  if (!check_keywords()) return 1;
+
+  size_t tokens = 0;
+  double lexSecs = run(rounds, false, &tokens);
+  double stmts = static_cast<double>(rounds * kStatementCount);
+  std::cout << "[Result] lex only     -> " << static_cast<long>(stmts / lexSecs)
+            << " statements/s | " << static_cast<long>(tokens / lexSecs)
+            << " tokens/s\n";
+  double parseSecs = run(rounds, true, &tokens);
+  std::cout << "[Result] lex + parse  -> "
+            << static_cast<long>(stmts / parseSecs) << " statements/s\n";
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_lexer: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
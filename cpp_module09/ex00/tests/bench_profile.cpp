@@ -0,0 +1,107 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_profile.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/06 15:37:12 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/06 15:40:26 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Cost of a ProfileScope with no Profile running (what every build pays)
+// and with one running (EXPLAIN ANALYZE), then EXPLAIN ANALYZE on a SELECT
+// so the operator rows can be eyeballed.
+//   bench_profile [probes=10000000] [rows=200000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// Not inlined, so the loop body is the same call with or without the probe
+__attribute__((noinline)) static size_t work(size_t i) {
+  return i * 2654435761u;
+}
+
+__attribute__((noinline)) static size_t probed(size_t i) {
+  ProfileScope probe("op", i);
+  probe.rows(i);
+  return i * 2654435761u;
+}
+
+static double perCallNs(size_t n, bool withProbe, size_t& sink) {
+  std::clock_t start = std::clock();
+  for (size_t i = 0; i < n; ++i) sink += withProbe ? probed(i) : work(i);
+  return secondsSince(start) * 1e9 / static_cast<double>(n);
+}
+
+struct Prices {
+  void columns(Database& db) const {
+    db.addColumn("date");
+    db.addColumn("price", ColumnType::DOUBLE);
+  }
+  void cells(size_t i, std::vector<std::string>& c) const {
+    std::ostringstream d, p;
+    d << 2010 + i % 14 << "-01-01";
+    p << (i * 7919) % 100000 / 100.0;
+    c[0] = d.str();
+    c[1] = p.str();
+  }
+};
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 10000000;
+  size_t rows = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 200000;
+  size_t sink = 0;
+
+  double bare = perCallNs(n, false, sink);
+  double idle = perCallNs(n, true, sink);
+  std::cout << "[Result] probe, no profile: " << idle - bare
+            << " ns per scope (" << bare << " ns bare call)\n";
+  if (Profile::current() != NULL) {
+    std::cout << "[FAIL] a profile is running\n";
+    return 1;
+  }
+
+  size_t active = n / 100;  // every scope appends a row to the profile
+  Profile profile;
+  profile.start();
+  double on = perCallNs(active, true, sink);
+  profile.stop();
+  std::cout << "[Result] probe, profiling: " << on - bare << " ns per scope ("
+            << profile.ops().size() << " recorded)\n";
+  if (profile.ops().size() != active) {
+    std::cout << "[FAIL] expected " << active << " operators\n";
+    return 1;
+  }
+
+  Database db = makeTable(rows, Prices());
+  Executor ex;
+  ex.addTable("t", db);
+  double secs;
+  run(ex, "SET CACHE 0", secs);  // time the statement, not a cache hit
+  std::string sql =
+      "EXPLAIN ANALYZE SELECT date, price FROM t WHERE price > 500 "
+      "ORDER BY price DESC LIMIT 10";
+  std::cout << run(ex, sql, secs) << "\n";
+  return sink == 42 ? 1 : 0;  // keep sink alive
+}
+
+#else
+
+int main() {
+  std::cout << "bench_profile: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,177 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_render.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/08 10:12:40 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/08 10:31:05 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Unicode::displayWidth against the wcwidth() version it replaced, on a
+// table of mostly-ASCII cells with some accents, CJK and emoji, then a
+// full TableRenderer::render with the per-cell width memo and without.
+// Widths must agree with wcwidth on the samples (when a UTF-8 locale
+// exists) and both renders must print the same bytes.
+//   bench_render [cells=1000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <wchar.h>
+
+#include <clocale>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// The previous displayWidth: same state machine, wcwidth() per code point
+static size_t wcwidthWidth(const std::string& str) {
+  size_t width = 0;
+  size_t index = 0;
+  bool inZwjSeq = false;
+  int regionalCount = 0;
+  while (index < str.size()) {
+    uint32_t cp = Unicode::decodeUTF8(str, index);
+    if (cp == 0) continue;
+    if (cp >= 0x1F1E6 && cp <= 0x1F1FF) {
+      if (++regionalCount == 1)
+        width += 2;
+      else
+        regionalCount = 0;
+      continue;
+    }
+    regionalCount = 0;
+    if (cp == 0x200D) {
+      inZwjSeq = true;
+      continue;
+    }
+    if (cp >= 0x1F3FB && cp <= 0x1F3FF) continue;
+    if ((cp >= 0xE0020 && cp <= 0xE007F) || cp == 0xE0001) continue;
+    if (inZwjSeq) {
+      inZwjSeq = false;
+      continue;
+    }
+    int w = wcwidth(static_cast<wchar_t>(cp));
+    width += w > 0 ? static_cast<size_t>(w) : 0;
+  }
+  return width;
+}
+
+static const char* kSamples[] = {
+    "",
+    "2011-01-03",
+    "hello, world",
+    "tab\there",
+    "caf\xC3\xA9 cr\xC3\xA8me",                         // café crème
+    "\xE6\x97\xA5\xE6\x9C\xAC\xE8\xAA\x9E",             // 日本語
+    "\xEF\xBC\xA1\xEF\xBC\xA2",                         // fullwidth ＡＢ
+    "e\xCC\x81",                                        // e + combining acute
+    "\xF0\x9F\x9A\x80 launch",                          // 🚀
+    "\xF0\x9F\x91\x8D\xF0\x9F\x8F\xBD",                 // 👍🏽
+    "\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7 FR",              // 🇫🇷
+    "\xF0\x9F\x91\xA8\xE2\x80\x8D\xF0\x9F\x91\xA9\xE2"  // 👨‍👩‍👧
+    "\x80\x8D\xF0\x9F\x91\xA7",
+    "a\xE2\x80\x8D" "b",                                // a ZWJ b
+    "\xE2\x94\x8C\xE2\x94\x80\xE2\x94\x90",             // ┌─┐
+    "soft\xC2\xAD" "hyphen",
+    "\xED\x95\x9C\xEA\xB5\xAD\xEC\x96\xB4",             // 한국어
+};
+
+static std::string cellText(size_t i) {
+  static const char* kRare[] = {
+      "caf\xC3\xA9", "\xE6\x97\xA5\xE6\x9C\xAC", "\xF0\x9F\x9A\x80 up",
+      "\xF0\x9F\x87\xAB\xF0\x9F\x87\xB7"};
+  if (i % 50 == 7) return kRare[(i / 50) % 4];  // 2% non-ASCII
+  std::string s = "cell ";
+  for (size_t n = i % 997; n > 0; n /= 10) s += static_cast<char>('0' + n % 10);
+  return s;
+}
+
+int main(int argc, char** argv) {
+  size_t cells = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+
+  if (std::setlocale(LC_CTYPE, "C.UTF-8") ||
+      std::setlocale(LC_CTYPE, "en_US.UTF-8")) {
+    size_t n = sizeof(kSamples) / sizeof(kSamples[0]);
+    for (size_t i = 0; i < n; ++i) {
+      size_t a = Unicode::displayWidth(kSamples[i]);
+      size_t b = wcwidthWidth(kSamples[i]);
+      if (a != b) {
+        std::cout << "[FAIL] sample " << i << ": " << a << " columns, wcwidth "
+                  << b << "\n";
+        return 1;
+      }
+    }
+    std::cout << "[Result] " << n << " samples match wcwidth\n";
+  } else {
+    std::cout << "[Result] no UTF-8 locale: wcwidth parity not checked\n";
+  }
+
+  const size_t ncols = 4;
+  Database db;
+  for (size_t c = 0; c < ncols; ++c) db.addColumn(std::string("c") += '0' + c);
+  Table& tbl = db.table();
+  const std::vector<Column>& cols = tbl.columns();
+  std::vector<std::string> texts;
+  texts.reserve(cells);
+  for (size_t i = 0; i < cells; ++i) texts.push_back(cellText(i));
+  for (size_t r = 0; r * ncols < cells; ++r) {
+    Row row = tbl.newRow();
+    for (size_t c = 0; c < ncols && r * ncols + c < cells; ++c)
+      row.setCell(cols[c].id(), texts[r * ncols + c]);
+    tbl.addRow(row);
+  }
+
+  size_t sumOld = 0, sumNew = 0;
+  double start = now();
+  for (size_t i = 0; i < cells; ++i) sumOld += wcwidthWidth(texts[i]);
+  double oldSecs = now() - start;
+  start = now();
+  for (size_t i = 0; i < cells; ++i) sumNew += Unicode::displayWidth(texts[i]);
+  double newSecs = now() - start;
+  std::cout << "[Result] displayWidth | " << cells << " cells | wcwidth "
+            << oldSecs * 1e3 << " ms | table " << newSecs * 1e3 << " ms | x"
+            << (newSecs > 0 ? oldSecs / newSecs : 0) << "\n";
+  if (sumOld != sumNew) {
+    std::cout << "[FAIL] " << sumNew << " columns in all, wcwidth " << sumOld
+              << "\n";
+    return 1;
+  }
+
+  // Memoized: autoWidth measures once and renderRows reuses the widths.
+  // Remeasured: a plain width pass, then renderRows measures every cell.
+  RenderConfig memo;
+  RenderConfig remeasure;
+  remeasure.autoWidth = false;
+  start = now();
+  std::string a = TableRenderer(memo).render(tbl);
+  double memoSecs = now() - start;
+  start = now();
+  tbl.calculateColumnWidths();
+  std::string b = TableRenderer(remeasure).render(tbl);
+  double plainSecs = now() - start;
+  std::cout << "[Result] render | " << cells << " cells | " << a.size()
+            << " bytes | memo " << memoSecs * 1e3 << " ms | remeasure "
+            << plainSecs * 1e3 << " ms\n";
+  if (a != b) {
+    std::cout << "[FAIL] renders differ\n";
+    return 1;
+  }
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_render: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,211 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_serve.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/10 14:05:51 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/10 14:42:18 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// A QueryServer on a thread of its own, then: the round trip of a single
+// `date | value` line and of a small SQL statement, one request in flight;
+// and concurrent clients streaming a whole input file through client(),
+// each of which must get back exactly what processInputFile prints.
+//   bench_serve [round trips=20000] [clients=8] [lines per client=100000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <fcntl.h>
+#include <pthread.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitCoinExchange.hpp"
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/QueryServer.hpp"
+
+class PriceLookup : public QueryServer::Lookup {
+ public:
+  explicit PriceLookup(const BitcoinExchange& btc) : _btc(btc) {}
+  void lookup(const std::string& line, bool first, std::ostream& out) {
+    if (first && BitcoinExchange::isHeaderLine(line)) return;
+    _btc.processLine(line, out, out);
+  }
+
+ private:
+  const BitcoinExchange& _btc;
+};
+
+static void* serveThread(void* arg) {
+  static_cast<QueryServer*>(arg)->run();
+  return NULL;
+}
+
+static std::string slurp(const std::string& path) {
+  std::ifstream in(path.c_str());
+  std::ostringstream s;
+  s << in.rdbuf();
+  return s.str();
+}
+
+// Sends line, reads until the reply's last newline; false on error
+static bool roundTrip(int fd, const std::string& line, size_t replyLines) {
+  if (write(fd, line.data(), line.size()) !=
+      static_cast<ssize_t>(line.size()))
+    return false;
+  char buf[65536];
+  while (replyLines > 0) {
+    ssize_t r = read(fd, buf, sizeof(buf));
+    if (r <= 0) return false;
+    for (ssize_t i = 0; i < r; ++i)
+      if (buf[i] == '\n') --replyLines;
+  }
+  return true;
+}
+
+static int connectTo(const std::string& path) {
+  struct sockaddr_un addr;
+  std::memset(&addr, 0, sizeof(addr));
+  addr.sun_family = AF_UNIX;
+  std::memcpy(addr.sun_path, path.data(), path.size());
+  int fd = socket(AF_UNIX, SOCK_STREAM, 0);
+  if (connect(fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)))
+    return -1;
+  return fd;
+}
+
+struct ClientRun {
+  std::string sock;
+  std::string input;
+  std::string output;
+  int status;
+};
+
+static void* clientThread(void* arg) {
+  ClientRun* run = static_cast<ClientRun*>(arg);
+  int in = open(run->input.c_str(), O_RDONLY);
+  int out = open(run->output.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+  run->status = QueryServer::client(run->sock, in, out);
+  close(in);
+  close(out);
+  return NULL;
+}
+
+int main(int argc, char** argv) {
+  size_t trips = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 20000;
+  size_t clients = argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 8;
+  size_t lines = argc > 3 ? static_cast<size_t>(std::atol(argv[3])) : 100000;
+
+  char dir[] = "/tmp/bench_serve.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  std::string base(dir);
+  std::string csv = base + "/data.csv", input = base + "/input.txt";
+  std::string sock = base + "/btc.sock";
+  {
+    std::ofstream out(csv.c_str());
+    out << "date,exchange_rate\n";
+    for (size_t i = 0; i < 5000; ++i)
+      out << day(i) << "," << static_cast<double>(i * 37 % 99991) / 10 << "\n";
+    std::ofstream in(input.c_str());
+    in << "date | value\n";
+    for (size_t i = 0; i < lines; ++i)
+      in << day(i * 7 % 5200) << " | " << (i % 13 == 0 ? "-1" : "2.5") << "\n";
+  }
+
+  BitcoinExchange btc(csv);
+  Executor executor;
+  {
+    Database prices;
+    prices.loadFromCsv(csv);
+    executor.addTable("btc", prices);
+  }
+  double secs;
+  run(executor, "SET CACHE 0", secs);  // time round trips, not cache hits
+  PriceLookup lookup(btc);
+  QueryServer server(executor, lookup);
+  server.listen(sock);
+  pthread_t thread;
+  pthread_create(&thread, NULL, serveThread, &server);
+
+  int fd = connectTo(sock);
+  if (fd < 0) {
+    std::cout << "[FAIL] cannot connect\n";
+    return 1;
+  }
+  double start = now();
+  for (size_t i = 0; i < trips; ++i)
+    if (!roundTrip(fd, day(i % 5000) + " | 1\n", 1)) {
+      std::cout << "[FAIL] lookup round trip\n";
+      return 1;
+    }
+  double lookupUs = (now() - start) * 1e6 / static_cast<double>(trips);
+  size_t sqlTrips = trips / 10;
+  start = now();
+  for (size_t i = 0; i < sqlTrips; ++i)
+    if (!roundTrip(fd, "COUNT btc WHERE exchange_rate > 5000;\n", 6)) {
+      std::cout << "[FAIL] SQL round trip\n";
+      return 1;
+    }
+  double sqlUs = (now() - start) * 1e6 / static_cast<double>(sqlTrips);
+  close(fd);
+  std::cout << "[Result] round trip | lookup " << lookupUs << " us | COUNT "
+            << sqlUs << " us\n";
+
+  std::ostringstream expected;
+  {
+    std::streambuf* out = std::cout.rdbuf(expected.rdbuf());
+    std::streambuf* err = std::cerr.rdbuf(expected.rdbuf());
+    btc.processInputFile(input);
+    std::cout.rdbuf(out);
+    std::cerr.rdbuf(err);
+  }
+  std::vector<ClientRun> runs(clients);
+  std::vector<pthread_t> threads(clients);
+  start = now();
+  for (size_t i = 0; i < clients; ++i) {
+    std::ostringstream name;
+    name << base << "/out" << i;
+    runs[i].sock = sock;
+    runs[i].input = input;
+    runs[i].output = name.str();
+    pthread_create(&threads[i], NULL, clientThread, &runs[i]);
+  }
+  for (size_t i = 0; i < clients; ++i) pthread_join(threads[i], NULL);
+  secs = now() - start;
+  for (size_t i = 0; i < clients; ++i)
+    if (runs[i].status != 0 || slurp(runs[i].output) != expected.str()) {
+      std::cout << "[FAIL] client " << i << " got a different answer\n";
+      return 1;
+    }
+  std::cout << "[Result] " << clients << " clients x " << lines
+            << " lines | " << secs * 1e3 << " ms | "
+            << static_cast<double>(clients * lines) / secs / 1e6
+            << " M lines/s\n";
+
+  server.stop();
+  pthread_join(thread, NULL);
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_serve: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
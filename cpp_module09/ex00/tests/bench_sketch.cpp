@@ -0,0 +1,208 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_sketch.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/04 10:12:37 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/04 10:15:02 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// STATS with sketches (KLL percentiles, HyperLogLog distinct) against the
+// exact path: time, rank error of p50/p90/p99, distinct error, and the same
+// again after merging sketches built over four separate tables.  Through
+// the Executor, STATS must stay exact unless APPROX asks for sketches.
+//   bench_sketch [rows=2000000] [distinct=500000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+static unsigned long g_seed = 42;
+static unsigned long nextRand() {
+  g_seed = g_seed * 6364136223846793005UL + 1442695040888963407UL;
+  return g_seed >> 33;
+}
+
+// Skewed prices: a key in [0, distinct) squared, so the tail is long
+static std::vector<Table> makeTables(size_t rows, size_t distinct,
+                                     size_t parts) {
+  std::vector<Table> tables(parts);
+  for (size_t p = 0; p < parts; ++p) tables[p].addColumn(Column("price"));
+  for (size_t i = 0; i < rows; ++i) {
+    Table& tbl = tables[i % parts];
+    double k = static_cast<double>(nextRand() % distinct);
+    std::ostringstream v;
+    v << k * k / 1000.0;
+    Row row = tbl.newRow();
+    row.setCell(tbl.columns()[0].id(), v.str());
+    tbl.addRow(row);
+  }
+  return tables;
+}
+
+// |rank(x) / n - q|: how far the reported value sits from the asked rank
+static double rankError(const std::vector<double>& sorted, double x,
+                        double q) {
+  double lo = static_cast<double>(
+      std::lower_bound(sorted.begin(), sorted.end(), x) - sorted.begin());
+  double hi = static_cast<double>(
+      std::upper_bound(sorted.begin(), sorted.end(), x) - sorted.begin());
+  double n = static_cast<double>(sorted.size());
+  if (q * n >= lo && q * n < hi) return 0.0;
+  return std::min(std::fabs(lo / n - q), std::fabs(hi / n - q));
+}
+
+static bool report(const char* label, const Statistics::ColumnStats& got,
+                   const Statistics::ColumnStats& exact,
+                   const std::vector<double>& sorted, double secs) {
+  double e50 = rankError(sorted, got.median, 0.5);
+  double e90 = rankError(sorted, got.p90, 0.9);
+  double e99 = rankError(sorted, got.p99, 0.99);
+  double ed = std::fabs(got.distinct - exact.distinct) / exact.distinct;
+  std::cout << "[Result] " << label << " " << secs * 1e3
+            << " ms | rank error p50 " << e50 << " p90 " << e90 << " p99 "
+            << e99 << " | distinct " << static_cast<size_t>(got.distinct)
+            << " vs " << static_cast<size_t>(exact.distinct) << " (" << ed * 100
+            << "%)\n";
+  // k = 200 and 2^14 registers: ~1% rank error, ~0.8% standard error
+  if (got.count != exact.count ||
+      std::fabs(got.mean - exact.mean) > 1e-9 * std::fabs(exact.mean) ||
+      std::fabs(got.stdDev - exact.stdDev) > 1e-6 * exact.stdDev) {
+    std::cout << "[FAIL] " << label << ": moments differ from exact\n";
+    return false;
+  }
+  if (e50 > 0.03 || e90 > 0.03 || e99 > 0.03 || ed > 0.05) {
+    std::cout << "[FAIL] " << label << ": error out of bounds\n";
+    return false;
+  }
+  return true;
+}
+
+// STATS and COUNT(DISTINCT) through the Executor: exact unless APPROX,
+// and APPROX sketches only inputs above Statistics::kExactRows; the column
+// name resolves in any case
+static bool statements(const Table& big) {
+  Database small, large;
+  small.addColumn("price", ColumnType::DOUBLE);
+  static const char* kPrices[] = {"3", "1", "4", "1", "5"};
+  for (size_t i = 0; i < 5; ++i) {
+    std::map<std::string, std::string> row;
+    row["price"] = kPrices[i];
+    small.addRow(row);
+  }
+  large.table() = big;
+  Executor ex;
+  ex.addTable("small", small);
+  ex.addTable("big", large);
+  bool sketch = big.rowCount() > Statistics::kExactRows;
+  struct Case {
+    const char* sql;
+    bool sketched;
+  } cases[] = {
+      {"STATS price FROM small", false},
+      {"STATS price FROM small APPROX", false},
+      {"COUNT(DISTINCT price) FROM small APPROX", false},
+      {"STATS price FROM big", false},
+      {"STATS price FROM big EXACT", false},
+      {"STATS price FROM big APPROX", sketch},
+      {"COUNT(DISTINCT price) FROM big APPROX", sketch},
+  };
+  double secs;
+  for (size_t i = 0; i < sizeof(cases) / sizeof(cases[0]); ++i) {
+    std::string out = run(ex, cases[i].sql, secs);
+    if ((out.find('~') != std::string::npos) != cases[i].sketched) {
+      std::cout << "[FAIL] " << cases[i].sql << ": expected "
+                << (cases[i].sketched ? "sketched" : "exact") << " output\n";
+      return false;
+    }
+  }
+  // columns resolve as in the other aggregates: any case, unknown throws
+  if (run(ex, "STATS PRICE FROM small", secs) !=
+      run(ex, "STATS price FROM small", secs)) {
+    std::cout << "[FAIL] STATS PRICE differs from STATS price\n";
+    return false;
+  }
+  try {
+    run(ex, "STATS nosuch FROM small", secs);
+    std::cout << "[FAIL] STATS on an unknown column did not throw\n";
+    return false;
+  } catch (const std::runtime_error&) {
+  }
+  std::cout << "[Result] STATS exact by default; APPROX on " << big.rowCount()
+            << " rows: " << (sketch ? "sketched" : "exact, under kExactRows")
+            << "\n";
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 2000000;
+  size_t distinct =
+      argc > 2 ? static_cast<size_t>(std::atol(argv[2])) : 500000;
+  const size_t parts = 4;
+
+  std::vector<Table> tables = makeTables(n, distinct, parts);
+  std::vector<const Table*> all;
+  for (size_t p = 0; p < parts; ++p) all.push_back(&tables[p]);
+
+  std::clock_t start = std::clock();
+  Statistics::ColumnStats exact = Statistics::analyze(all, "price");
+  double exactSecs = secondsSince(start);
+  std::cout << "[Result] exact " << exactSecs * 1e3 << " ms | " << n
+            << " rows, " << static_cast<size_t>(exact.distinct)
+            << " distinct\n";
+
+  std::vector<double> sorted;
+  for (size_t p = 0; p < parts; ++p)
+    for (size_t i = 0; i < tables[p].rows().size(); ++i)
+      sorted.push_back(
+          Query::toDouble(tables[p].rows()[i].getValue("price")));
+  std::sort(sorted.begin(), sorted.end());
+
+  // One sketch streamed over every table
+  start = std::clock();
+  Statistics::Sketch one;
+  for (size_t p = 0; p < parts; ++p) Statistics::scan(tables[p], "price", one);
+  Statistics::ColumnStats streamed = one.result();
+  double streamSecs = secondsSince(start);
+  if (!report("sketch", streamed, exact, sorted, streamSecs)) return 1;
+  std::cout << "[Result] sketch memory: " << one.quantiles.retained()
+            << " KLL items + " << (1u << HyperLogLog::kPrecision)
+            << " HLL registers\n";
+
+  // One sketch per table, merged as partial results would be
+  start = std::clock();
+  std::vector<Statistics::Sketch> partial(parts);
+  for (size_t p = 0; p < parts; ++p)
+    Statistics::scan(tables[p], "price", partial[p]);
+  Statistics::Sketch merged;
+  for (size_t p = 0; p < parts; ++p) merged.merge(partial[p]);
+  Statistics::ColumnStats mergedStats = merged.result();
+  double mergeSecs = secondsSince(start);
+  if (!report("merged", mergedStats, exact, sorted, mergeSecs)) return 1;
+  return statements(tables[0]) ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_sketch: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,341 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_suite.cpp                                    :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/13 09:44:05 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/13 11:37:52 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Every stage of the Database / CSV stack on Generator::writeCsv trade
+// files of 1K, 10K, ... up to max rows: generating the file, CSV::Document
+// ::load, Database::loadFromCsv, a filtered SELECT, Statistics::analyze
+// and TableRenderer::render (up to kMaxRenderRows).  Each size runs in a
+// child process so its peak RSS is its own.  The results are written as
+// JSON and compared with a stored baseline: a stage more than 25% slower
+// is reported, not failed, since the baseline comes from another machine.
+// The generator must write the same bytes at 1 and at 4 threads.
+//   bench_suite [max rows=1000000] [--json out.json]
+//               [--baseline tests/bench_suite_baseline.json]
+//               [--threads n] [--seed s]
+//   bench_suite --generate prices|trades|employees <rows> <path>
+//               [--threads n] [--seed s]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+#include "vendor/csv.hpp"
+
+static const size_t kMaxRenderRows = 1000000;
+
+static long peakRssKb() {
+  struct rusage ru;
+  getrusage(RUSAGE_SELF, &ru);
+  return ru.ru_maxrss;  // KiB on Linux
+}
+
+static off_t fileSize(const std::string& path) {
+  struct stat st;
+  return ::stat(path.c_str(), &st) == 0 ? st.st_size : 0;
+}
+
+struct Result {
+  size_t rows;
+  std::string stage;
+  double seconds;
+  double bytes;  // bytes the stage read or wrote, 0 if none
+  long rssKb;
+  bool skipped;
+};
+
+static std::string json(const Result& r) {
+  std::ostringstream s;
+  s << "{\"rows\": " << r.rows << ", \"stage\": \"" << r.stage << "\", ";
+  if (r.skipped) {
+    s << "\"skipped\": true}";
+    return s.str();
+  }
+  s << "\"seconds\": " << r.seconds << ", \"rows_per_sec\": "
+    << static_cast<double>(r.rows) / r.seconds;
+  if (r.bytes > 0) s << ", \"mb_per_sec\": " << r.bytes / r.seconds / 1e6;
+  s << ", \"peak_rss_kb\": " << r.rssKb << "}";
+  return s.str();
+}
+
+// The value of "key": in a line json() wrote; empty if absent
+static std::string field(const std::string& line, const std::string& key) {
+  std::string tag = "\"" + key + "\": ";
+  size_t at = line.find(tag);
+  if (at == std::string::npos) return "";
+  at += tag.size();
+  if (line[at] == '"') return line.substr(at + 1, line.find('"', at + 1) - at - 1);
+  return line.substr(at, line.find_first_of(",}", at) - at);
+}
+
+// Runs every stage on rows rows; one JSON object per line to out
+static void stages(size_t rows, const std::string& dir, size_t threads,
+                   uint64_t seed, std::ostream& out) {
+  std::ostringstream name;
+  name << dir << "/trades_" << rows << ".csv";
+  std::string csv = name.str();
+  Result r;
+  r.rows = rows;
+  r.skipped = false;
+
+  double start = now();
+  Generator::writeCsv(csv, Generator::TRADES, rows, seed, threads);
+  r.stage = "generate";
+  r.seconds = now() - start;
+  r.bytes = static_cast<double>(fileSize(csv));
+  r.rssKb = peakRssKb();
+  out << json(r) << "\n";
+
+  {
+    start = now();
+    CSV::Document doc;
+    doc.load(csv);
+    r.stage = "csv_document_load";
+    r.seconds = now() - start;
+    r.rssKb = peakRssKb();
+    out << json(r) << "\n";
+  }
+
+  Executor executor;
+  run(executor, "SET CACHE 0", r.seconds);  // every stage runs for real
+  {
+    start = now();
+    Database db;
+    db.loadFromCsv(csv);
+    r.stage = "database_load_csv";
+    r.seconds = now() - start;
+    r.rssKb = peakRssKb();
+    out << json(r) << "\n";
+    executor.addTable("trades", db);
+  }
+  ::unlink(csv.c_str());
+  r.bytes = 0;
+
+  {
+    std::string sql = "SELECT id, price FROM trades WHERE quantity > 990";
+    run(executor, sql, r.seconds);
+    r.stage = "select_where";
+    r.rssKb = peakRssKb();
+    out << json(r) << "\n";
+  }
+
+  Database* trades = executor.findTable("trades");
+  {
+    start = now();
+    Statistics::analyze(trades->table(), "price");
+    r.stage = "statistics_analyze";
+    r.seconds = now() - start;
+    r.rssKb = peakRssKb();
+    out << json(r) << "\n";
+  }
+
+  r.stage = "render";
+  if (rows > kMaxRenderRows) {
+    r.skipped = true;
+  } else {
+    start = now();
+    TableRenderer renderer;
+    std::string text = renderer.render(trades->table());
+    r.seconds = now() - start;
+    r.bytes = static_cast<double>(text.size());
+    r.rssKb = peakRssKb();
+  }
+  out << json(r) << "\n";
+}
+
+// The stages of one size in a child process, so peak RSS is per size
+static bool runSize(size_t rows, const std::string& dir, size_t threads,
+                    uint64_t seed, std::vector<std::string>& lines) {
+  int fds[2];
+  if (pipe(fds) != 0) return false;
+  pid_t pid = fork();
+  if (pid == 0) {
+    ::close(fds[0]);
+    std::ostringstream out;
+    stages(rows, dir, threads, seed, out);
+    std::string s = out.str();
+    ssize_t w = ::write(fds[1], s.data(), s.size());
+    _exit(w == static_cast<ssize_t>(s.size()) ? 0 : 1);
+  }
+  ::close(fds[1]);
+  std::string text;
+  char buf[4096];
+  ssize_t n;
+  while ((n = ::read(fds[0], buf, sizeof(buf))) > 0)
+    text.append(buf, static_cast<size_t>(n));
+  ::close(fds[0]);
+  int status = 0;
+  waitpid(pid, &status, 0);
+  std::istringstream in(text);
+  std::string line;
+  while (std::getline(in, line)) lines.push_back(line);
+  return WIFEXITED(status) && WEXITSTATUS(status) == 0;
+}
+
+static std::string slurp(const std::string& path) {
+  std::ifstream in(path.c_str());
+  std::ostringstream s;
+  s << in.rdbuf();
+  return s.str();
+}
+
+static int generate(int argc, char** argv, size_t threads, uint64_t seed) {
+  if (argc < 5) {
+    std::cout << "usage: bench_suite --generate prices|trades|employees "
+                 "<rows> <path>\n";
+    return 1;
+  }
+  std::string kind = argv[2];
+  Generator::Dataset dataset = Generator::TRADES;
+  if (kind == "prices")
+    dataset = Generator::PRICES;
+  else if (kind == "employees")
+    dataset = Generator::EMPLOYEES;
+  else if (kind != "trades") {
+    std::cout << "[FAIL] unknown dataset " << kind << "\n";
+    return 1;
+  }
+  size_t rows = static_cast<size_t>(std::atol(argv[3]));
+  double start = now();
+  uint64_t bytes = Generator::writeCsv(argv[4], dataset, rows, seed, threads);
+  double secs = now() - start;
+  std::cout << "[Result] " << rows << " " << kind << " rows | "
+            << static_cast<double>(bytes) / 1e6 << " MB | " << secs
+            << " s | " << static_cast<double>(bytes) / secs / 1e6
+            << " MB/s\n";
+  return 0;
+}
+
+int main(int argc, char** argv) {
+  size_t maxRows = 1000000;
+  size_t threads = 0;
+  uint64_t seed = 42;
+  std::string jsonPath = "bench_suite.json";
+  std::string baselinePath = "tests/bench_suite_baseline.json";
+  for (int i = 1; i < argc; ++i) {
+    std::string arg = argv[i];
+    if (arg == "--threads" && i + 1 < argc)
+      threads = static_cast<size_t>(std::atol(argv[++i]));
+    else if (arg == "--seed" && i + 1 < argc)
+      seed = static_cast<uint64_t>(std::strtoull(argv[++i], NULL, 10));
+    else if (arg == "--json" && i + 1 < argc)
+      jsonPath = argv[++i];
+    else if (arg == "--baseline" && i + 1 < argc)
+      baselinePath = argv[++i];
+    else if (arg != "--generate" && i == 1)
+      maxRows = static_cast<size_t>(std::atol(argv[i]));
+  }
+  if (argc > 1 && std::string(argv[1]) == "--generate")
+    return generate(argc, argv, threads, seed);
+
+  char dir[] = "/tmp/bench_suite.XXXXXX";
+  if (!mkdtemp(dir)) return 1;
+  std::string base(dir);
+
+  // Same bytes whatever the thread count
+  {
+    std::string one = base + "/one.csv", four = base + "/four.csv";
+    for (int d = Generator::PRICES; d <= Generator::EMPLOYEES; ++d) {
+      Generator::Dataset kind = static_cast<Generator::Dataset>(d);
+      Generator::writeCsv(one, kind, 100000, seed, 1);
+      Generator::writeCsv(four, kind, 100000, seed, 4);
+      if (slurp(one) != slurp(four)) {
+        std::cout << "[FAIL] generator output depends on the thread count\n";
+        return 1;
+      }
+    }
+    Generator::writeCsv(four, Generator::TRADES, 1000, seed + 1, 4);
+    if (slurp(four) == slurp(one)) {
+      std::cout << "[FAIL] the seed does not change the output\n";
+      return 1;
+    }
+    ::unlink(one.c_str());
+    ::unlink(four.c_str());
+  }
+
+  std::map<std::string, double> baseline;  // "rows stage" -> seconds
+  {
+    std::ifstream in(baselinePath.c_str());
+    std::string line;
+    while (std::getline(in, line)) {
+      std::string secs = field(line, "seconds");
+      if (!secs.empty())
+        baseline[field(line, "rows") + " " + field(line, "stage")] =
+            std::atof(secs.c_str());
+    }
+  }
+
+  std::vector<std::string> lines;
+  for (size_t rows = 1000; rows <= maxRows; rows *= 10) {
+    size_t first = lines.size();
+    if (!runSize(rows, base, threads, seed, lines)) {
+      std::cout << "[FAIL] " << rows << " rows: a stage failed\n";
+      return 1;
+    }
+    for (size_t i = first; i < lines.size(); ++i) {
+      const std::string& l = lines[i];
+      std::string key = field(l, "rows") + " " + field(l, "stage");
+      std::cout << "[Result] " << rows << " rows | " << field(l, "stage");
+      if (!field(l, "skipped").empty()) {
+        std::cout << " | skipped\n";
+        continue;
+      }
+      double secs = std::atof(field(l, "seconds").c_str());
+      std::cout << " | " << secs * 1e3 << " ms | "
+                << std::atof(field(l, "rows_per_sec").c_str()) / 1e6
+                << " M rows/s | peak " << field(l, "peak_rss_kb") << " KiB";
+      std::map<std::string, double>::const_iterator b = baseline.find(key);
+      if (b != baseline.end() && b->second > 0) {
+        double ratio = secs / b->second;
+        std::cout << " | x" << ratio << " baseline";
+        if (ratio > 1.25 && secs > 0.01) std::cout << " [Regression]";
+      }
+      std::cout << "\n";
+    }
+  }
+
+  std::ofstream out(jsonPath.c_str());
+  out << "{\"bench\": \"suite\", \"seed\": " << seed << ", \"threads\": "
+      << (threads ? threads : MorselPool::hardwareThreads())
+      << ", \"results\": [\n";
+  for (size_t i = 0; i < lines.size(); ++i)
+    out << "  " << lines[i] << (i + 1 < lines.size() ? ",\n" : "\n");
+  out << "]}\n";
+  std::cout << "[Result] JSON written to " << jsonPath << "\n";
+
+  std::string cmd = "rm -rf " + base;
+  return std::system(cmd.c_str()) == 0 ? 0 : 1;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_suite: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
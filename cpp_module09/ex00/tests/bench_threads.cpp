@@ -0,0 +1,106 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_threads.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/05 16:20:51 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/05 16:24:13 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Full-table scans through the Executor at 1, 2, 4, ... threads up to the
+// CPU count (SET THREADS).  Wall time, not std::clock, since CPU time adds
+// up across threads.  Every thread count must print the same result.
+//   bench_threads [rows=4000000] [max threads=online CPUs]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// Random dates and prices, the same for every run
+struct Prices {
+  unsigned long seed;
+  Prices() : seed(42) {}
+  void columns(Database& db) const {
+    db.addColumn("date");
+    db.addColumn("price", ColumnType::DOUBLE);
+  }
+  void cells(size_t, std::vector<std::string>& c) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    std::ostringstream d, p;
+    d << 2010 + (seed >> 33) % 14 << "-0" << 1 + (seed >> 40) % 9 << "-1"
+      << (seed >> 45) % 10;
+    p << static_cast<double>((seed >> 20) % 100000) / 100.0;
+    c[0] = d.str();
+    c[1] = p.str();
+  }
+};
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 4000000;
+  size_t maxThreads = argc > 2 ? static_cast<size_t>(std::atol(argv[2]))
+                               : MorselPool::hardwareThreads();
+
+  Executor ex;
+  ex.addTable("t", makeTable(n, Prices()));
+  double secs;
+  run(ex, "SET CACHE 0", secs);  // time the scans, not result cache hits
+
+  static const char* queries[] = {
+      "SUM price FROM t",
+      "SUM price FROM t WHERE price > 500",
+      "COUNT t WHERE date >= '2020-01-01' AND price < 100",
+      "SELECT date FROM t WHERE price > 999.9 LIMIT 3",
+  };
+  const size_t nq = sizeof(queries) / sizeof(queries[0]);
+
+  // 1, 2, 4, ... and then the maximum itself, odd or not
+  std::vector<size_t> counts;
+  for (size_t threads = 1; threads < maxThreads; threads *= 2)
+    counts.push_back(threads);
+  counts.push_back(maxThreads ? maxThreads : 1);
+
+  std::vector<std::string> expected(nq);
+  std::vector<double> base(nq);
+  for (size_t c = 0; c < counts.size(); ++c) {
+    size_t threads = counts[c];
+    std::ostringstream set;
+    set << "SET THREADS " << threads;
+    run(ex, set.str(), secs);
+    for (size_t q = 0; q < nq; ++q) {
+      std::string out = run(ex, queries[q], secs);
+      if (threads == 1) {
+        expected[q] = out;
+        base[q] = secs;
+      } else if (out != expected[q]) {
+        std::cout << "[FAIL] " << queries[q] << " differs at " << threads
+                  << " threads\n";
+        return 1;
+      }
+      std::cout << "[Result] " << threads << " thread"
+                << (threads > 1 ? "s" : " ") << " | " << n << " rows | "
+                << secs * 1e3 << " ms | x" << (secs > 0 ? base[q] / secs : 0)
+                << " | " << queries[q] << "\n";
+    }
+  }
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_threads: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
@@ -0,0 +1,117 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_util.hpp                                     :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/16 10:02:37 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/16 10:41:15 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+#ifndef BENCH_UTIL_HPP
+#define BENCH_UTIL_HPP
+
+// Timing and fixture helpers shared by the tests/bench_*.cpp programs.
+// Not a test itself: the Makefile only builds tests/*.cpp.
+
+#include <sys/time.h>
+
+#include <cstdio>
+#include <ctime>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "BitCoinExchange.hpp"
+
+// Wall-clock seconds: what a multi-threaded run costs, unlike std::clock
+inline double now() {
+  struct timeval tv;
+  gettimeofday(&tv, NULL);
+  return static_cast<double>(tv.tv_sec) +
+         static_cast<double>(tv.tv_usec) / 1e6;
+}
+
+// CPU seconds of this process since start
+inline double secondsSince(std::clock_t start) {
+  return static_cast<double>(std::clock() - start) / CLOCKS_PER_SEC;
+}
+
+// Day i of a calendar of 28-day months from January of firstYear: every
+// i gives a valid date, and dates sort as i does
+inline std::string day(size_t i, unsigned firstYear = 2009) {
+  char s[11];
+  std::snprintf(s, sizeof(s), "%04u-%02u-%02u",
+                static_cast<unsigned>(firstYear + i / 336),
+                static_cast<unsigned>(1 + i / 28 % 12),
+                static_cast<unsigned>(1 + i % 28));
+  return s;
+}
+
+// What processInputFile prints for input, stdout and stderr together
+inline std::string answers(const BitcoinExchange& btc,
+                           const std::string& input) {
+  std::ostringstream out;
+  std::streambuf* savedOut = std::cout.rdbuf(out.rdbuf());
+  std::streambuf* savedErr = std::cerr.rdbuf(out.rdbuf());
+  btc.processInputFile(input);
+  std::cout.rdbuf(savedOut);
+  std::cerr.rdbuf(savedErr);
+  return out.str();
+}
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// One statement through the Executor; secs gets execute() alone, the
+// lexing and parsing left out
+inline std::string run(Executor& ex, const std::string& sql, double& secs) {
+  Lexer lexer(sql);  // keeps a reference to sql
+  std::vector<Token> toks = lexer.tokenize();
+  Parser parser(toks);
+  AST::Statement stmt = parser.parse();
+  double start = now();
+  std::string out = ex.execute(stmt);
+  secs = now() - start;
+  return out;
+}
+
+// The same column names, and the same cells row by row
+inline bool sameTable(Table& a, Table& b) {
+  const std::vector<Column>& ac = a.columns();
+  const std::vector<Column>& bc = b.columns();
+  if (ac.size() != bc.size() || a.rowCount() != b.rowCount()) return false;
+  for (size_t c = 0; c < ac.size(); ++c)
+    if (ac[c].name() != bc[c].name()) return false;
+  const std::vector<Row>& ar = a.rows();
+  const std::vector<Row>& br = b.rows();
+  for (size_t i = 0; i < ar.size(); ++i)
+    for (size_t c = 0; c < ac.size(); ++c)
+      if (a.value(ar[i], ac[c]) != b.value(br[i], bc[c])) return false;
+  return true;
+}
+
+// A table of rows rows: gen.columns(db) adds the columns, then
+// gen.cells(i, cells) fills row i's cells in column order
+template <typename Gen>
+Database makeTable(size_t rows, Gen gen) {
+  Database db;
+  gen.columns(db);
+  Table& tbl = db.table();
+  const std::vector<Column>& cols = tbl.columns();
+  std::vector<std::string> cells(cols.size());
+  for (size_t i = 0; i < rows; ++i) {
+    gen.cells(i, cells);
+    Row row = tbl.newRow();
+    for (size_t c = 0; c < cols.size(); ++c)
+      row.setCell(cols[c].id(), cells[c]);
+    tbl.addRow(row);
+  }
+  return db;
+}
+#endif
+
+#endif  // BENCH_UTIL_HPP
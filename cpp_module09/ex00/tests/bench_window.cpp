@@ -0,0 +1,106 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_window.cpp                                   :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/03 09:27:44 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/03 09:29:10 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// Sliding windows (Window::slide) against naive per-row re-aggregation of
+// the whole frame, for 7/30/200-row frames.  Results must agree.
+//   bench_window [rows=1000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cmath>
+#include <cstdlib>
+#include <ctime>
+#include <iostream>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/Database_utils.hpp"
+
+// What repeated "AVG ... WHERE date BETWEEN" amounts to: O(frame) per row
+static void naive(Window::Func f, const std::vector<double>& v,
+                  const std::vector<char>& ok, size_t preceding,
+                  std::vector<double>& out) {
+  out.assign(v.size(), 0.0);
+  for (size_t i = 0; i < v.size(); ++i) {
+    size_t from = i >= preceding ? i - preceding : 0;
+    double acc = 0;
+    size_t n = 0;
+    for (size_t j = from; j <= i; ++j) {
+      if (!ok[j]) continue;
+      if (f == Window::MIN)
+        acc = n == 0 || v[j] < acc ? v[j] : acc;
+      else if (f == Window::MAX)
+        acc = n == 0 || v[j] > acc ? v[j] : acc;
+      else
+        acc += v[j];
+      ++n;
+    }
+    out[i] = (f == Window::AVG && n > 0) ? acc / static_cast<double>(n) : acc;
+  }
+}
+
+int main(int argc, char** argv) {
+  size_t n = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 1000000;
+
+  // Random walk around 30k with a few non-numeric holes
+  std::vector<double> v(n);
+  std::vector<char> ok(n, 1);
+  unsigned long seed = 7;
+  double price = 30000;
+  for (size_t i = 0; i < n; ++i) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    price += static_cast<double>((seed >> 33) % 2001) / 10.0 - 100.0;
+    v[i] = price;
+    if ((seed >> 20) % 997 == 0) ok[i] = 0;
+  }
+
+  static const size_t frames[] = {7, 30, 200};
+  static const Window::Func funcs[] = {Window::AVG, Window::MIN, Window::MAX};
+  static const char* names[] = {"AVG", "MIN", "MAX"};
+
+  for (size_t fr = 0; fr < 3; ++fr) {
+    for (size_t fn = 0; fn < 3; ++fn) {
+      std::vector<double> fast, slow;
+      std::vector<char> has;
+      std::clock_t start = std::clock();
+      Window::slide(funcs[fn], v, ok, frames[fr] - 1, fast, has);
+      double fastSecs = secondsSince(start);
+      start = std::clock();
+      naive(funcs[fn], v, ok, frames[fr] - 1, slow);
+      double slowSecs = secondsSince(start);
+
+      for (size_t i = 0; i < n; ++i) {
+        if (has[i] && std::fabs(fast[i] - slow[i]) > 1e-6 * std::fabs(slow[i])) {
+          std::cout << "[FAIL] " << names[fn] << " frame " << frames[fr]
+                    << " row " << i << ": " << fast[i] << " != " << slow[i]
+                    << "\n";
+          return 1;
+        }
+      }
+      std::cout << "[Result] " << names[fn] << " " << frames[fr]
+                << " rows over " << n << " -> sliding " << fastSecs * 1e3
+                << " ms | naive " << slowSecs * 1e3 << " ms | x"
+                << (fastSecs > 0 ? slowSecs / fastSecs : 0) << "\n";
+    }
+  }
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_window: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif
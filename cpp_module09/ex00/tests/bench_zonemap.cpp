@@ -0,0 +1,285 @@
+/* ************************************************************************** */
+/*                                                                            */
+/*                                                        :::      ::::::::   */
+/*   bench_zonemap.cpp                                  :+:      :+:    :+:   */
+/*                                                    +:+ +:+         +:+     */
+/*   By: dlesieur <dlesieur@student.42.fr>          +#+  +:+       +#+        */
+/*                                                +#+#+#+#+#+   +#+           */
+/*   Created: 2026/03/15 12:14:40 by dlesieur          #+#    #+#             */
+/*   Updated: 2026/03/15 13:02:18 by dlesieur         ###   ########.fr       */
+/*                                                                            */
+/* ************************************************************************** */
+
+// WHERE scans through the Executor on ten years of ticks in date order,
+// with zone maps skipping the segments no row of which can match: narrow
+// date ranges, a lookup of one order id (Bloom filters, the ids are in no
+// order) and an OR of two days, against a condition nothing can prune.
+// Each query runs twice, the first paying for the zone maps, and reports
+// the segments kept.  Every count must match a plain row-by-row check,
+// compressed too, and writes must not leave stale zone maps behind.
+//   bench_zonemap [rows=4000000]
+// Build with `make bench` (needs the MySQLite engine).
+
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "tests/bench_util.hpp"
+
+#if HAVE_MY_SQL_LITE
+#include "vendor/MySQLiteRepl.hpp"
+
+// The COUNT result cell of a rendered table, colours aside
+static std::string countOf(const std::string& out) {
+  static const std::string bar = "\xe2\x94\x82";  // U+2502
+  size_t at = out.find("COUNT");
+  if (at == std::string::npos) return "";
+  size_t end = out.rfind(bar, out.find('\n', at));
+  size_t begin = out.rfind(bar, end - 1);
+  std::string cell;
+  for (size_t i = begin + bar.size(); i < end; ++i) {
+    if (out[i] == '\033')
+      while (i < end && out[i] != 'm') ++i;
+    else if (out[i] != ' ')
+      cell += out[i];
+  }
+  return cell;
+}
+
+// A count as the aggregate prints it: a double, so big ones round
+static std::string printed(long n) {
+  std::ostringstream o;
+  o << static_cast<double>(n);
+  return o.str();
+}
+
+// Ten years of trading days in order, an id per order in no order at all
+struct Ticks {
+  size_t rows;
+  unsigned long seed;
+  explicit Ticks(size_t n) : rows(n), seed(7) {}
+  void columns(Database& db) const {
+    db.addColumn("date");
+    db.addColumn("id");
+    db.addColumn("price", ColumnType::DOUBLE);
+  }
+  void cells(size_t i, std::vector<std::string>& c) {
+    seed = seed * 6364136223846793005UL + 1442695040888963407UL;
+    size_t day = i * 3600 / rows;  // 360-day years keep the dates simple
+    char date[16], id[16], price[16];
+    std::snprintf(date, sizeof(date), "%04lu-%02lu-%02lu",
+                  static_cast<unsigned long>(2014 + day / 360),
+                  static_cast<unsigned long>(1 + day % 360 / 30),
+                  static_cast<unsigned long>(1 + day % 30));
+    std::snprintf(id, sizeof(id), "O%010lu", (seed >> 24) % 10000000000UL);
+    std::snprintf(price, sizeof(price), "%.2f",
+                  static_cast<double>((seed >> 20) % 100000) / 100.0);
+    c[0] = date;
+    c[1] = id;
+    c[2] = price;
+  }
+};
+
+struct Cond {
+  const char* column;
+  const char* op;
+  std::string value;
+  const char* logic;  // to the next condition
+};
+
+// The REPL's comparison, restated: numbers when both sides read as one
+static bool holds(const std::string& cell, const Cond& c) {
+  double a = 0, b = 0;
+  bool numeric = ZoneMap::readNumber(cell, a) &&
+                 ZoneMap::readNumber(c.value, b);
+  std::string op(c.op);
+  if (op == "=") return numeric ? a == b : cell == c.value;
+  if (op == "!=") return numeric ? a != b : cell != c.value;
+  if (op == "<") return numeric ? a < b : cell < c.value;
+  if (op == ">") return numeric ? a > b : cell > c.value;
+  if (op == "<=") return numeric ? a <= b : cell <= c.value;
+  return numeric ? a >= b : cell >= c.value;
+}
+
+static const Column& column(const Table& tbl, const char* name) {
+  const std::vector<Column>& cols = tbl.columns();
+  size_t c = 0;
+  while (cols[c].name() != name) ++c;
+  return cols[c];
+}
+
+// Rows matching conds, checked one by one, and segments the maps keep
+static long expected(const Table& tbl, const std::vector<Cond>& conds,
+                     size_t& kept) {
+  const std::vector<Row>& rows = tbl.rows();
+  long n = 0;
+  for (size_t r = 0; r < rows.size(); ++r) {
+    bool result = true;
+    for (size_t i = 0; i < conds.size(); ++i) {
+      bool next =
+          holds(tbl.value(rows[r], column(tbl, conds[i].column)), conds[i]);
+      if (i == 0)
+        result = next;
+      else if (std::string(conds[i - 1].logic) == "OR")
+        result = result || next;
+      else
+        result = result && next;
+    }
+    n += result;
+  }
+  MorselPool pool;
+  kept = 0;
+  for (size_t seg = 0; seg < MorselPool::morsels(rows.size()); ++seg) {
+    bool keep = true;
+    for (size_t i = 0; i < conds.size(); ++i) {
+      const ZoneMap& zones =
+          tbl.zoneMap(column(tbl, conds[i].column), pool);
+      bool next =
+          zones.mayMatch(seg, ZoneMap::Probe(conds[i].op, conds[i].value));
+      if (i == 0)
+        keep = next;
+      else if (std::string(conds[i - 1].logic) == "OR")
+        keep = keep || next;
+      else
+        keep = keep && next;
+    }
+    kept += keep;
+  }
+  return n;
+}
+
+static std::string where(const std::vector<Cond>& conds) {
+  std::string sql;
+  for (size_t i = 0; i < conds.size(); ++i) {
+    if (i) sql += std::string(" ") + conds[i - 1].logic + " ";
+    sql += std::string(conds[i].column) + " " + conds[i].op + " '" +
+           conds[i].value + "'";
+  }
+  return sql;
+}
+
+// One query, cold and warm, against its row-by-row count; warm is timed
+// against fullScan when given, and set otherwise
+static bool query(Executor& ex, const Table& tbl, const char* what,
+                  const std::vector<Cond>& conds, double& fullScan) {
+  std::string sql = "COUNT t WHERE " + where(conds);
+  double cold, warm;
+  std::string got = countOf(run(ex, sql, cold));
+  run(ex, sql, warm);
+  size_t kept;
+  long want = expected(tbl, conds, kept);
+  std::cout << "[Result] " << what << " | " << want << " rows | "
+            << kept << "/" << MorselPool::morsels(tbl.rowCount())
+            << " segments | cold " << cold * 1e3 << " ms | warm "
+            << warm * 1e3 << " ms";
+  if (fullScan > 0)
+    std::cout << " (x" << fullScan / warm << ")";
+  else
+    fullScan = warm;
+  std::cout << "\n";
+  if (got != printed(want)) {
+    std::cout << "[FAIL] " << sql << ": " << got << " rows, expected " << want
+              << "\n";
+    return false;
+  }
+  return true;
+}
+
+static Cond cond(const char* column, const char* op, const std::string& value,
+                 const char* logic = "AND") {
+  Cond c = {column, op, value, logic};
+  return c;
+}
+
+static bool queries(Executor& ex, const Table& tbl, const std::string& id) {
+  std::vector<Cond> full(1, cond("price", "!=", "-1"));
+  double secs = 0;
+  if (!query(ex, tbl, "price != -1 (nothing to skip)", full, secs))
+    return false;
+
+  std::vector<Cond> week;
+  week.push_back(cond("date", ">=", "2019-03-01"));
+  week.push_back(cond("date", "<", "2019-03-08"));
+  std::vector<Cond> day(1, cond("date", "=", "2021-07-04"));
+  std::vector<Cond> two;
+  two.push_back(cond("date", "=", "2015-02-10", "OR"));
+  two.push_back(cond("date", "=", "2022-11-20"));
+  std::vector<Cond> one(1, cond("id", "=", id));
+  std::vector<Cond> mixed;
+  mixed.push_back(cond("date", ">=", "2016-06-01"));
+  mixed.push_back(cond("date", "<=", "2016-06-30"));
+  mixed.push_back(cond("price", ">", "990"));
+  std::vector<Cond> cheap(1, cond("price", "<", "0.5"));
+  return query(ex, tbl, "one week", week, secs) &&
+         query(ex, tbl, "one day", day, secs) &&
+         query(ex, tbl, "two days (OR)", two, secs) &&
+         query(ex, tbl, "one order id (Bloom)", one, secs) &&
+         query(ex, tbl, "a month, price > 990", mixed, secs) &&
+         query(ex, tbl, "price < 0.5 (not clustered)", cheap, secs);
+}
+
+// Writes bump the version: stale maps would hide these rows.  The table
+// ends as it began.
+static bool writes(Executor& ex) {
+  struct Step {
+    const char* sql;
+    long rows;
+  } steps[] = {
+      {"COUNT t WHERE date = '2030-01-01'", 0},
+      {"INSERT INTO t (date, id, price) VALUES ('2030-01-01', 'new', '1')",
+       -1},
+      {"COUNT t WHERE date = '2030-01-01'", 1},
+      {"COUNT t WHERE id = 'new'", 1},
+      {"UPDATE t SET date = '2031-05-05' WHERE id = 'new'", -1},
+      {"COUNT t WHERE date > '2030-06-01'", 1},
+      {"DELETE FROM t WHERE date >= '2030-01-01'", -1},
+      {"COUNT t WHERE date >= '2030-01-01'", 0},
+  };
+  double secs;
+  for (size_t i = 0; i < sizeof(steps) / sizeof(steps[0]); ++i) {
+    std::string out = run(ex, steps[i].sql, secs);
+    if (steps[i].rows >= 0 && countOf(out) != printed(steps[i].rows)) {
+      std::cout << "[FAIL] stale zone map: " << steps[i].sql << " gave "
+                << countOf(out) << ", expected " << steps[i].rows << "\n";
+      return false;
+    }
+  }
+  std::cout << "[Result] INSERT / UPDATE / DELETE: zone maps rebuilt\n";
+  return true;
+}
+
+int main(int argc, char** argv) {
+  size_t rows = argc > 1 ? static_cast<size_t>(std::atol(argv[1])) : 4000000;
+
+  double start = now();
+  Database db = makeTable(rows, Ticks(rows));
+  std::cout << "[Result] " << rows << " ticks over ten years built in "
+            << now() - start << " s, "
+            << MorselPool::morsels(rows) << " segments of "
+            << MorselPool::kMorselRows << " rows\n";
+  // expected counts come from db, the Executor works on its own copy
+  const Table& tbl = db.table();
+  std::string id = tbl.value(tbl.rows()[rows / 3], column(tbl, "id"));
+  Executor ex;
+  ex.addTable("t", db);
+  double secs;
+  run(ex, "SET CACHE 0", secs);  // warm means zone maps built, not cached
+  if (!queries(ex, tbl, id) || !writes(ex)) return 1;
+
+  run(ex, "COMPRESS t", secs);
+  std::cout << "[Result] compressed\n";
+  if (!queries(ex, tbl, id) || !writes(ex)) return 1;
+  return 0;
+}
+
+#else
+
+int main() {
+  std::cout << "bench_zonemap: MySQLite disabled (build with `make bench`)\n";
+  return 0;
+}
+
+#endif